@@ -37,10 +37,20 @@
 
 %{
 
+#include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
+#include <map>
 #include <queue>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <cstdlib>
+#include <cerrno>
+
+#include <sys/stat.h>
 
 #if defined(HAVE_CONFIG_H)
 #include "config.h"
@@ -192,9 +202,47 @@ to_string(const long v)
   return ( os.str() );
 }
 
-//! report error message m, line number n and context t with optinal abort.
+//! serializes messages to standard error from concurrent scanners.
+mutex cerr_mutex;
+
+////////////////////////////////////////////////////////////////////////////////
+// scanner
+////////////////////////////////////////////////////////////////////////////////
+
+//! class that implements the filter scanner for a single input.
+//! all scanner state is held by the instance so that several inputs
+//! may be filtered concurrently, each by its own scanner.
+class BDIF_Scanner : public yyFlexLexer
+{
+  public:
+    //! \brief scanner constructor.
+    //! \param i  scanner input stream.
+    //! \param o  filtered output stream.
+    //! \param f  input file name (prefixed to error messages when set).
+    BDIF_Scanner( istream* i, ostream* o, const string& f = "" )
+      : yyFlexLexer( i, o ), out( *o ), file( f ), errors( 0 ) {}
+
+    using FlexLexer::yylex;
+
+    // scan() implementation generated by flex. see #define YY_DECL above.
+    //! filter the input stream to the output stream.
+    int scan( void );
+
+    //! return the number of input errors reported.
+    int get_errors( void ) { return errors; }
+
+  private:
+    //! report error message m, line number n and context t, and continue.
+    void error( const string& m, const int &n = 0, const string &t = "" );
+
+    Block             cb;       //!< current comment block.
+    ostream&          out;      //!< filtered output stream.
+    string            file;     //!< input file name.
+    int               errors;   //!< number of input errors reported.
+};
+
 void
-error( const string& m, const int &n = 0, const string &t = "", bool a = false ) {
+BDIF_Scanner::error( const string& m, const int &n, const string &t ) {
   string om;
 
   om = "ERROR in input, " + m;
@@ -202,26 +250,22 @@ error( const string& m, const int &n = 0, const string &t = "", bool a = false )
   if( n )           om += ", at line " + to_string( n );
   if( t.length() )  om += ", near [" + t + "]";
 
-  if( a )
-    om += ", aborting..." ;
-  else
-    om += ", continuing..." ;
+  om += ", continuing..." ;
 
-  cerr << om << endl;
-  cout << "<tt>" << om << "</tt><br>\n";
+  {
+    lock_guard<mutex> lock( cerr_mutex );
 
-  if( a )
-    exit( EXIT_FAILURE );
-  else
-    return;
-}
+    if ( file.length() ) cerr << file << ": ";
+    cerr << om << endl;
+  }
 
-////////////////////////////////////////////////////////////////////////////////
-// scanner allocation
-////////////////////////////////////////////////////////////////////////////////
+  out << "<tt>" << om << "</tt><br>\n";
 
-//! comment block global variable allocation.
-Block cb;
+  ++errors;
+}
+
+#undef  YY_DECL
+#define YY_DECL int BDIF_Scanner::scan(void)
 
 //! @}
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
@@ -232,6 +276,7 @@ Block cb;
 
 %option c++
 %option prefix="bash_dif"
+%option yyclass="BDIF_Scanner"
 %option stack
 %option yylineno
 %option noyywrap
@@ -285,9 +330,9 @@ kw_aparamo                        [\\@](?i:aparamo){ws}
 
 <INITIAL>{bcmt}                   { cb.app_text( "/**" ); yy_push_state(COMMENT); }
 <INITIAL>{cmtld}                  { cb.app_text( "///" ); yy_push_state(READCL); }
-<INITIAL>{nr}                     { cb.app_text( YYText() ); cout << cb.format(); }
+<INITIAL>{nr}                     { cb.app_text( YYText() ); out << cb.format(); }
 <INITIAL>.                        ;
-<INITIAL><<EOF>>                  { cout << cb.format(); return 0; }
+<INITIAL><<EOF>>                  { out << cb.format(); return 0; }
 
   /*
     inside comment block
@@ -299,7 +344,8 @@ kw_aparamo                        [\\@](?i:aparamo){ws}
 <COMMENT>{cmtli}                  { cb.app_text( " *" ); }
 <COMMENT>{nr}                     { cb.app_text( YYText() ); }
 <COMMENT>.                        { cb.app_text( YYText() ); }
-<COMMENT><<EOF>>                  { error("unterminated comment block", lineno()); }
+<COMMENT><<EOF>>                  { error("unterminated comment block", lineno());
+                                    out << cb.format(); return 0; }
 
   /*
     read comment line outside of comment block
@@ -359,6 +405,133 @@ kw_aparamo                        [\\@](?i:aparamo){ws}
 //! \ingroup bash_dif_src
 //! @{
 
+////////////////////////////////////////////////////////////////////////////////
+//
+// batch mode
+//
+////////////////////////////////////////////////////////////////////////////////
+
+//! return path f with the current directory components removed and
+//! each parent directory component applied to the component before it.
+//! leading parent directory components of a relative path, which have
+//! nothing to apply to, are kept.
+string
+normal_path( const string& f ) {
+  vector<string> c;
+  bool root = ( f.length() && f[0] == '/' );
+
+  size_t b = 0;
+  while ( b <= f.length() ) {
+    size_t e = f.find( '/', b );
+    if ( e == string::npos ) e = f.length();
+
+    string p = f.substr( b, e - b );
+    if ( !p.compare("..") && c.size() && c.back().compare("..") )
+      c.pop_back();
+    else if ( !p.compare("..") && root && c.empty() )
+      ;
+    else if ( p.length() && p.compare(".") )
+      c.push_back( p );
+
+    b = e + 1;
+  }
+
+  string r = root ? "/" : "";
+  for ( size_t i = 0; i < c.size(); ++i ) {
+    if ( i ) r += "/";
+    r += c[i];
+  }
+
+  return( r );
+}
+
+//! return the mirror of input path f under directory d.
+//! f is normalized (see normal_path()) and its root and leading parent
+//! directory components are removed, so that the output always lies
+//! within d. distinct inputs may therefore share a mirror, which the
+//! batch checks before filtering.
+string
+mirror_path( const string& d, const string& f ) {
+  string n = normal_path( f );
+
+  size_t b = 0;
+  while ( b < n.length() ) {
+    if ( n[b] == '/' )
+      ++b;
+    else if ( !n.compare( b, 3, "../" ) )
+      b += 3;
+    else if ( !n.compare( b, string::npos, ".." ) )
+      b += 2;
+    else
+      break;
+  }
+
+  string r = d;
+  if ( b < n.length() ) {
+    if ( r.length() && r[r.length()-1] != '/' ) r += "/";
+    r += n.substr( b );
+  }
+
+  return( r );
+}
+
+//! create each missing parent directory of file f.
+bool
+make_parents( const string& f ) {
+  for ( size_t p = f.find( '/', 1 ); p != string::npos; p = f.find( '/', p + 1 ) ) {
+    string d = f.substr( 0, p );
+
+    if ( mkdir( d.c_str(), 0777 ) != 0 && errno != EEXIST )
+      return( false );
+  }
+
+  return( true );
+}
+
+//! filter input file f to output file o, or to standard output when
+//! o is empty. returns false when a file can not be read or written.
+bool
+filter_file( const string& f, const string& o ) {
+  ifstream infile ( f.c_str() );
+
+  if ( !infile.good() ) {
+    lock_guard<mutex> lock( cerr_mutex );
+    cerr << "ERROR: unable to open file [" << f << "]" << endl;
+    return( false );
+  }
+
+  if ( o.empty() ) {
+    BDIF_Scanner scanner( &infile, &cout );
+
+    while( scanner.scan() != 0 )
+      ;
+
+    return( true );
+  }
+
+  // filter to memory, so that a partial output file is never written
+  ostringstream os;
+  BDIF_Scanner scanner( &infile, &os, f );
+
+  while( scanner.scan() != 0 )
+    ;
+
+  ofstream outfile;
+  if ( make_parents( o ) )
+    outfile.open( o.c_str(), ofstream::out | ofstream::trunc );
+
+  if ( outfile.is_open() )
+    outfile << os.str();
+
+  if ( !outfile.is_open() || !outfile.good() ) {
+    lock_guard<mutex> lock( cerr_mutex );
+    cerr << "ERROR: unable to write file [" << o << "]" << endl;
+    return( false );
+  }
+
+  return( true );
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //
 // main
@@ -367,18 +540,40 @@ kw_aparamo                        [\\@](?i:aparamo){ws}
 
 //! program main.
 int
+#if defined(AMU_MULTICALL)
+bash_dif_main( int argc, char** argv ) {
+#else
 main( int argc, char** argv ) {
-  string  arg1;
+#endif
+  vector<string> files;
+  string  odir;
+  int     jobs    = 0;
   bool    help    = false;
   bool    version = false;
-
-  if ( argc == 2 ) {
-    arg1 = argv[1];
-    help    = !arg1.compare("-h") || !arg1.compare("--help");
-    version = !arg1.compare("-v") || !arg1.compare("--version");
+  bool    bad     = false;
+
+  for ( int i = 1; i < argc; ++i ) {
+    string a = argv[i];
+
+    if      ( !a.compare("-h") || !a.compare("--help") )
+      help = true;
+    else if ( !a.compare("-v") || !a.compare("--version") )
+      version = true;
+    else if ( ( !a.compare("-o") || !a.compare("--output-dir") ) && i+1 < argc )
+      odir = argv[++i];
+    else if ( ( !a.compare("-j") || !a.compare("--jobs") ) && i+1 < argc )
+      jobs = atoi( argv[++i] );
+    else if ( a.length() > 1 && a[0] == '-' )
+      bad = true;
+    else
+      files.push_back( a );
   }
 
-  if ( help || argc != 2 ) {
+  // multiple inputs require an output directory
+  if ( files.size() > 1 && odir.empty() )
+    bad = true;
+
+  if ( help || bad || ( files.empty() && !version ) ) {
     cout << argv[0] << " " << PACKAGE_VERSION << endl
          << endl
          << "Doxygen input filter for bash source files. Can be used in\n"
@@ -390,10 +585,15 @@ main( int argc, char** argv ) {
          << endl
          << "Usage: " << endl
          << "  " << argv[0] << " ifile" << endl
+         << "  " << argv[0] << " -o dir [-j n] ifile..." << endl
          << endl
          << "Options: " << endl
-         << "  -h [ --help]     Print this message." << endl
-         << "  -v [ --version]  Report tool version." << endl
+         << "  -h [ --help]        Print this message." << endl
+         << "  -v [ --version]     Report tool version." << endl
+         << "  -o [ --output-dir]  Write each filtered input to the same" << endl
+         << "                      relative path under this directory." << endl
+         << "  -j [ --jobs]        Number of files filtered concurrently" << endl
+         << "                      (default: number of processors)." << endl
          << endl;
 
     if ( help ) exit( EXIT_SUCCESS );
@@ -405,24 +605,69 @@ main( int argc, char** argv ) {
     exit( EXIT_SUCCESS );
   }
 
-  std::ifstream infile ( arg1.c_str() );
+  // single input to standard output
+  if ( odir.empty() )
+    exit( filter_file( files.front(), "" ) ? EXIT_SUCCESS : EXIT_FAILURE );
 
-  if ( infile.good() ) {
+  // batch: each output must have one input: an input named twice is filtered
+  // once, and distinct inputs with the same mirror are an error.
+  vector<string> outs;
+  map<string, size_t> by_out;
+  bool unique = true;
 
-    bash_difFlexLexer* lexer = new bash_difFlexLexer( &infile , &cout );
-
-    while( lexer->yylex() != 0 )
-      ;
+  for ( size_t i = 0; i < files.size(); ) {
+    string o = mirror_path( odir, files[i] );
+    map<string, size_t>::iterator it = by_out.find( o );
 
-  } else {
+    if ( it == by_out.end() ) {
+      by_out[ o ] = outs.size();
+      outs.push_back( o );
+      ++i;
+    }
+    else if ( !normal_path( files[it->second] ).compare( normal_path( files[i] ) ) ) {
+      files.erase( files.begin() + i );
+    }
+    else {
+      cerr << "ERROR: inputs [" << files[it->second] << "] and [" << files[i]
+           << "] have the same output file [" << o << "]" << endl;
+      unique = false;
+      ++i;
+
+      // keep indexes of files and outs aligned
+      outs.push_back( o );
+    }
+  }
 
-    cerr << "ERROR: unable to open file [" << arg1 << "]" << endl;
+  if ( !unique )
     exit( EXIT_FAILURE );
 
-  }
+  // each worker takes the next unfiltered input
+  if ( jobs < 1 )
+    jobs = thread::hardware_concurrency();
+  if ( jobs < 1 )
+    jobs = 1;
+  if ( static_cast<size_t>(jobs) > files.size() )
+    jobs = files.size();
+
+  atomic<size_t>  next( 0 );
+  atomic<bool>    good( true );
+
+  auto worker = [&] ( void ) {
+    for ( size_t i = next++; i < files.size(); i = next++ )
+      if ( !filter_file( files[i], outs[i] ) )
+        good = false;
+  };
+
+  vector<thread> pool;
+  for ( int i = 1; i < jobs; ++i )
+    pool.push_back( thread( worker ) );
+
+  worker();
+
+  for ( vector<thread>::iterator it=pool.begin(); it!=pool.end(); ++it )
+    it->join();
 
-  infile.close();
-  exit( EXIT_SUCCESS );
+  exit( good ? EXIT_SUCCESS : EXIT_FAILURE );
 }
 
 //! @}
@@ -0,0 +1,145 @@
+/***************************************************************************//**
+
+  \file   openscad_amu_main.cpp
+
+  \author Roy Allen Sutton
+  \date   2016-2026
+
+  \copyright
+
+    This file is part of OpenSCAD AutoMake Utilities ([openscad-amu]
+    (https://royasutton.github.io/openscad-amu)).
+
+    openscad-amu is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    openscad-amu is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    [GNU General Public License] (https://www.gnu.org/licenses/gpl.html)
+    for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with openscad-amu.  If not, see <http://www.gnu.org/licenses/>.
+
+  \brief
+    Multi-call main source.
+
+  \details
+    Combines openscad-seam, openscad-dif, and bash-dif into a single
+    executable, so that the shared libraries are loaded and relocated
+    once for all tools. The tool is selected by the name the program is
+    invoked as (for example, through a symbolic link named
+    openscad-dif), or else by the first argument:
+
+    \verbatim
+    openscad-amu openscad-dif --version
+    \endverbatim
+
+    The sources of each tool are compiled with \c AMU_MULTICALL defined,
+    which renames the main function of each to the entry points below.
+*******************************************************************************/
+
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+#if defined(HAVE_CONFIG_H)
+#include "config.h"
+#endif
+
+using namespace std;
+
+//! openscad-seam program main.
+int openscad_seam_main(int argc, char** argv);
+//! openscad-dif program main.
+int openscad_dif_main(int argc, char** argv);
+//! bash-dif program main.
+int bash_dif_main(int argc, char** argv);
+
+namespace
+{
+  //! tool name and entry point.
+  struct tool_s
+  {
+    const char* name;
+    int (*main)(int argc, char** argv);
+  };
+
+  //! tools in this executable.
+  const tool_s tools[] =
+  {
+    { "openscad-seam",  openscad_seam_main },
+    { "openscad-dif",   openscad_dif_main },
+    { "bash-dif",       bash_dif_main }
+  };
+
+  //! return the tool named n (ignoring any directory and extension), else NULL.
+  const tool_s*
+  find_tool(const string& n)
+  {
+    string b = n.substr( n.find_last_of( "/\\" ) == string::npos
+                         ? 0 : n.find_last_of( "/\\" ) + 1 );
+
+    // executable extension
+    if ( b.length() > 4 && !b.compare( b.length() - 4, 4, ".exe" ) )
+      b.erase( b.length() - 4 );
+
+    for ( size_t i = 0; i < sizeof( tools ) / sizeof( tools[0] ); ++i )
+      if ( !b.compare( tools[i].name ) )
+        return( &tools[i] );
+
+    return( NULL );
+  }
+}
+
+
+//! program main.
+int
+main(int argc, char** argv)
+{
+  // invoked by tool name
+  if ( const tool_s* t = find_tool( argv[0] ) )
+    return( t->main( argc, argv ) );
+
+  // tool name as first argument
+  if ( argc > 1 )
+  {
+    if ( const tool_s* t = find_tool( argv[1] ) )
+    {
+      argv[1] = const_cast<char*>( t->name );
+      return( t->main( argc - 1, argv + 1 ) );
+    }
+
+    string a = argv[1];
+    if ( !a.compare( "-v" ) || !a.compare( "--version" ) )
+    {
+      cout << PACKAGE_VERSION << endl;
+      exit( EXIT_SUCCESS );
+    }
+  }
+
+  cerr << argv[0] << " " << PACKAGE_VERSION << endl
+       << endl
+       << "Multi-call executable for the openscad-amu tools." << endl
+       << endl
+       << "Usage: " << endl
+       << "  " << argv[0] << " tool [options]" << endl
+       << "  tool [options]    (when invoked through a link named tool)" << endl
+       << endl
+       << "Tools: " << endl;
+
+  for ( size_t i = 0; i < sizeof( tools ) / sizeof( tools[0] ); ++i )
+    cerr << "  " << tools[i].name << endl;
+
+  cerr << endl;
+
+  exit( ( argc > 1 ) ? EXIT_FAILURE : EXIT_SUCCESS );
+}
+
+
+/*******************************************************************************
+// eof
+*******************************************************************************/
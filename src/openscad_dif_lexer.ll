@@ -115,6 +115,7 @@ incr_var_post                     {id}("++"|"--")
 inc_copy                          ((?i:copy)|(?i:c))
 inc_no_switch                     ((?i:no_switch)|(?i:n))
 inc_search                        ((?i:search)|(?i:s))
+inc_once                          ((?i:once)|(?i:o))
 
   /* amu_if values, operations, arguments, and expressions */
 
@@ -196,13 +197,14 @@ if_expr_2a                        {if_arg}{wsnr}+{if_func_2a}{wsnr}+{if_arg}
 
   /*
     amu_include:
-    amu_include copy no_switch ( ${var1}/path/${var2}/file )
+    amu_include copy no_switch once ( ${var1}/path/${var2}/file )
   */
 
 <AMUINC>\(                        { apt(); BEGIN(AMUINCFNM); }
 <AMUINC>{inc_copy}                { apt(); inc_set_copy(true); }
 <AMUINC>{inc_no_switch}           { apt(); inc_set_switch(false); }
 <AMUINC>{inc_search}              { apt(); inc_set_search(true); }
+<AMUINC>{inc_once}                { apt(); inc_set_once(true); }
 <AMUINC>{ws}+                     { apt(); }
 <AMUINC>{nr}                      { apt(); }
 <AMUINC>.                         { error("in include", lineno(), YYText()); }
@@ -68,9 +68,13 @@ namespace
   const size_t ERROR_UNHANDLED_EXCEPTION = 1;
   const size_t ERROR_IN_COMMAND_LINE = 2;
   const size_t ERROR_UNABLE_TO_OPEN_FILE = 3;
+  const size_t DEPENDS_CHANGED = 4;
+  const size_t ERROR_WRITING_OUTPUT = 5;
 }
 
 
+namespace ODIF {
+
 //! output build information.
 void
 build_info(ostream& sout, const string& command_name)
@@ -172,13 +176,58 @@ debug_m(const bool& output, const string& message, const bool& newline=true)
 }
 
 
+//! output filter statistics page to debug page and standard error.
+void
+debug_stats(const bool output, const string& command_name)
+{
+  if ( output )
+  {
+    ostringstream ss;
+
+    ss << "     variable lookups: " << ODIF::env_var::get_lookup_count() << endl
+       << "      variable stores: " << ODIF::env_var::get_store_count() << endl
+       << "  value buffer reuses: " << ODIF::env_var::get_reuse_count() << endl
+       << "    result cache hits: " << ODIF::result_cache::get_hit_count() << endl
+       << "  result cache misses: " << ODIF::result_cache::get_miss_count() << endl
+       << "  result cache stores: " << ODIF::result_cache::get_put_count() << endl
+       << "   include file tests: " << ODIF::dir_index::get_test_count() << endl
+       << "  include dirs listed: " << ODIF::dir_index::get_list_count() << endl
+       << "   stat calls avoided: " << ODIF::dir_index::get_avoid_count() << endl
+       << "         asset copies: " << ODIF::copy_manifest::get_copy_count() << endl
+       << " asset copies skipped: " << ODIF::copy_manifest::get_skip_count() << endl
+       << "     regex cache hits: " << ODIF::ODIF_Scanner::get_regex_hit_count() << endl
+       << "   regex cache misses: " << ODIF::ODIF_Scanner::get_regex_miss_count() << endl
+       << "     file cache loads: " << ODIF::file_cache::get_load_count() << endl
+       << "      file cache hits: " << ODIF::file_cache::get_hit_count() << endl
+       << " word list cache hits: " << ODIF::word_list_cache::get_hit_count() << endl
+       << "        output writes: " << ODIF::output_sink::get_write_count() << endl;
+
+    cout << endl
+         << "//! \\cond __INCLUDE_FILTER_DEBUG__" << endl
+         << "/**" << endl
+         << "\\page debug_stats_" << command_name
+         << " Statistics (" << command_name << ")" << endl
+         << "\\verbatim" << endl
+         << ss.str()
+         << "\\endverbatim" << endl
+         << "*/" << endl
+         << "//! \\endcond" << endl;
+
+    cerr << "filter statistics begin:" << endl
+         << ss.str()
+         << "filter statistics end." << endl;
+  }
+}
+
+
 //! search for configuration file for given input file.
 bool
 find_config(
   const string input,
   const string auto_config,
   string& config,
-  const bool debug_filter)
+  const bool debug_filter,
+  vector<string>* tried = NULL)
 {
   path input_path ( input );
   path input_path_abs ( input_path.parent_path() );
@@ -226,6 +275,9 @@ find_config(
 
       debug_m(debug_filter, "  trying: [" + try_file.string() + "]");
 
+      if ( tried != NULL )
+        tried->push_back( try_file.string() );
+
       if ( exists(try_file) && is_regular_file(try_file) )
       {
         config = try_file.string();
@@ -236,11 +288,45 @@ find_config(
   return found;
 }
 
+//! \brief flush the output and exit with status c.
+//! \details the output buffer s is flushed and cout is restored to
+//!          buffer b when it was redirected (b not null). When writing
+//!          the output has failed, exit with an error status instead.
+void
+exit_output(output_sink& s, streambuf* b, const size_t c)
+{
+  if ( b != NULL )
+  {
+    cout.flush();
+    cout.rdbuf( b );
+  }
+
+  if ( !s.flush() )
+  {
+    cerr << "ERROR: unable to write output" << endl;
+    exit( ERROR_WRITING_OUTPUT );
+  }
+
+  exit( c );
+}
+
+} /* end namespace ODIF */
+
+using namespace ODIF;
+
 
 //! program main.
 int
+#if defined(AMU_MULTICALL)
+openscad_dif_main(int argc, char** argv)
+#else
 main(int argc, char** argv)
+#endif
 {
+  // buffered standard output (outlives the redirection of cout)
+  ODIF::output_sink sink;
+  streambuf* cout_buf = NULL;
+
   try
   {
     ////////////////////////////////////////////////////////////////////////////
@@ -250,6 +336,7 @@ main(int argc, char** argv)
 
     // command line
     string input;
+    string output;
     bool search           = true;
     vector<string> include_path;
     string doxygen_output;
@@ -261,6 +348,12 @@ main(int argc, char** argv)
     string auto_config;
     string config;
 
+    int jobs              = 1;
+    int timeout           = 0;
+    int cpu_limit         = 0;
+    int mem_limit         = 0;
+    string profile;
+    string depfile;
     bool debug_filter     = false;
 
     // configuration file
@@ -273,15 +366,30 @@ main(int argc, char** argv)
     string makefile_ext   = ".makefile";
     string openscad_path  = __OPENSCAD_PATH__;
     string openscad_ext   = ".scad";
+    string openscad_cache;
+    string search_cache;
+    string copy_policy    = "copy";
+    bool copy_hash        = false;
+    string copy_manifest;
+    int copy_threads      = 2;
 
     // other
     vector<string> scope_id_mf;
+    vector<string> search_depends;
+    UTIL::proc_limits limits;
+
+    // resolved configuration snapshot
+    ODIF::config_snapshot snapshot;
+    string snap_key;
 
     po::options_description opts_cli("Options (visible)");
     opts_cli.add_options()
       ("input,i",
           po::value<string>(&input)->required(),
-          "Input source file name.\n")
+          "Input source file name.")
+      ("output,o",
+          po::value<string>(&output),
+          "Output file name (default: standard output).\n")
       ("search,s",
           po::value<bool>(&search)->default_value(search),
           "Search make targets for references.")
@@ -306,6 +414,31 @@ main(int argc, char** argv)
       ("lib-path",
           po::value<string>(&lib_path)->default_value(lib_path),
           "Makefile script library path.\n")
+      ("jobs,j",
+          po::value<int>(&jobs)->default_value(jobs),
+          "Maximum concurrent external commands.")
+      ("timeout",
+          po::value<int>(&timeout)->default_value(timeout),
+          "External command and co-process response time limit\n"
+          "in seconds (0=none).")
+      ("cpu-limit",
+          po::value<int>(&cpu_limit)->default_value(cpu_limit),
+          "External command cpu time limit in seconds (0=none).")
+      ("mem-limit",
+          po::value<int>(&mem_limit)->default_value(mem_limit),
+          "External command memory limit in MiB (0=none).")
+      ("profile",
+          po::value<string>(&profile),
+          "Write a function call profile (Chrome trace) to file\n"
+          "(%f: input name, %p: process id; a directory: %f.%p.json).\n"
+          "Commands are run in sequence while profiling.")
+      ("depfile",
+          po::value<string>(&depfile),
+          "Write a make dependency file of the files read.")
+      ("check-depfile",
+          po::value<string>(),
+          "Exit with status 0 and report 'unchanged' when no file of\n"
+          "the dependency file is newer than it.\n")
       ("auto-config,a",
           po::value<string>(&auto_config),
           "Filter Auto configuration path.")
@@ -353,6 +486,28 @@ main(int argc, char** argv)
       ("openscad-ext",
           po::value<string>(&openscad_ext)->default_value(openscad_ext),
           "OpenSCAD script extension.")
+      ("openscad-cache",
+          po::value<string>(&openscad_cache),
+          "OpenSCAD in-line script result cache path.\n")
+      ("config-snapshot",
+          po::value<string>(),
+          "Resolved configuration snapshot (default: <auto-config>/.amu_config_snapshot).")
+      ("search-cache",
+          po::value<string>(&search_cache),
+          "Auto-search result cache path, used without a configuration\n"
+          "snapshot (default: <makefile-dir>/.amu_search_cache).\n")
+      ("copy-policy",
+          po::value<string>(&copy_policy)->default_value(copy_policy),
+          "Asset copy method: copy, hardlink, reflink, or symlink.")
+      ("copy-hash",
+          po::value<bool>(&copy_hash)->default_value(copy_hash),
+          "Compare asset content when copy metadata differs.")
+      ("copy-manifest",
+          po::value<string>(&copy_manifest),
+          "Asset copy manifest (default: <doxygen-output>/.amu_copy_manifest, none without doxygen-output).")
+      ("copy-threads",
+          po::value<int>(&copy_threads)->default_value(copy_threads),
+          "Background asset copy threads (0 copies in-line).")
     ;
 
     // all parsed options
@@ -411,11 +566,75 @@ main(int argc, char** argv)
         exit( SUCCESS );
       }
 
+      // check dependency file and exit
+      if ( vm.count("check-depfile") )
+      {
+        string changed;
+
+        if ( UTIL::depfile_check( vm["check-depfile"].as<string>(), changed ) )
+        {
+          cout << "unchanged" << endl;
+          exit( SUCCESS );
+        }
+
+        cout << "changed: " << changed << endl;
+        exit( DEPENDS_CHANGED );
+      }
+
+      // write standard output through the output buffer
+      if ( vm.count("output") )
+      {
+        string f = vm["output"].as<string>();
+
+        if ( !sink.open( f ) )
+        {
+          cerr << command_name << ": unable to open output file [" << f << "]" << endl;
+          exit( ERROR_UNABLE_TO_OPEN_FILE );
+        }
+      }
+      cout_buf = cout.rdbuf( &sink );
+
       debug_filter = ( vm.count("debug-filter")>0 );
 
       // begin filter debugging page
       debug_hf( debug_filter, true, command_name );
 
+      // use the project snapshot of resolved configurations (bypassed
+      // when debugging to show the complete resolution)
+      if ( !debug_filter )
+      {
+        if ( vm.count("config-snapshot") )
+          snapshot.set_path( vm["config-snapshot"].as<string>() );
+        else if ( vm.count("auto-config") )
+          snapshot.set_path( ( path(vm["auto-config"].as<string>())
+                               / ".amu_config_snapshot" ).string() );
+
+        // project key: working directory and command line without the
+        // input file, which is the same for each file of a project.
+        if ( snapshot.enabled() )
+        {
+          const string in = vm.count("input") ? vm["input"].as<string>() : "";
+
+          snap_key = current_path().string();
+          for ( int i=1; i < argc; ++i )
+          {
+            const string a = argv[i];
+
+            if ( a == in || a == "-i" || a == "--input"
+                 || a.compare( 0, 8, "--input=" ) == 0 )
+              continue;
+
+            snap_key += "\n" + a;
+          }
+        }
+      }
+
+      // the configuration file found and its parsed options are used
+      // from the snapshot when each file probed for them is unchanged.
+      ODIF::config_snapshot::entry_s ce;
+      string ck;
+      bool cached = false;
+
       // auto configuration
       if ( vm.count("auto-config") )
       {
@@ -428,8 +647,32 @@ main(int argc, char** argv)
         input = vm["input"].as<string>();
         auto_config = vm["auto-config"].as<string>();
 
-        debug_m(debug_filter, "attempting auto-configuration");
-        if ( find_config(input, auto_config, config, debug_filter) )
+        // the search depends on the input directory and name only.
+        const path ip( input );
+        ck = snap_key + "\nauto-config\n" + ip.parent_path().string()
+                      + "\n" + ip.stem().string();
+
+        bool found;
+
+        if ( (cached = snapshot.get( ck, ce )) )
+        {
+          found = !ce.text.empty();
+          if ( found ) config = ce.text;
+        }
+        else
+        {
+          debug_m(debug_filter, "attempting auto-configuration");
+
+          vector<string> tried;
+          found = find_config(input, auto_config, config, debug_filter, &tried);
+
+          for ( vector<string>::iterator it=tried.begin(); it!=tried.end(); ++it )
+            ODIF::config_snapshot::check( ce, *it );
+
+          if ( found ) ce.text = config;
+        }
+
+        if ( found )
         {
           debug_m(debug_filter, "configuration found.");
 
@@ -437,8 +680,18 @@ main(int argc, char** argv)
           vm.insert( make_pair("config", po::variable_value(config, true)) );
         } else {
           debug_m(debug_filter, "configuration not found.");
+
+          if ( !cached )
+            snapshot.put( ck, ce );
         }
       }
+      else if ( vm.count("config") )
+      {
+        config = vm["config"].as<string>();
+
+        ck = snap_key + "\nconfig\n" + absolute( config ).string();
+        cached = snapshot.get( ck, ce );
+      }
 
       // parse configuration file options
       if ( vm.count("config") )
@@ -447,34 +700,64 @@ main(int argc, char** argv)
         // get values from variable map directly.
         config = vm["config"].as<string>();
 
-        debug_m(debug_filter, "reading configuration file: [" + config + "]");
+        po::parsed_options co( &opts );
 
-        std::ifstream config_file ( config.c_str() );
+        if ( cached )
+        { // options as (name, value) pairs
+          for ( size_t i=0; i+1 < ce.paths.size(); i+=2 )
+            co.options.push_back
+              ( po::option( ce.paths[i], vector<string>( 1, ce.paths[i+1] ) ) );
+        }
+        else
+        {
+          debug_m(debug_filter, "reading configuration file: [" + config + "]");
 
-        if ( config_file.good() )
-        { // parse configuration file options
-          po::store(po::parse_config_file(config_file, opts, true), vm);
-        } else {
-          cerr << "ERROR: unable to open configuration file [" << config
-               << "]" << endl;
+          std::ifstream config_file ( config.c_str() );
 
-          exit( ERROR_UNABLE_TO_OPEN_FILE );
+          if ( !config_file.good() )
+          {
+            cerr << "ERROR: unable to open configuration file [" << config
+                 << "]" << endl;
+
+            exit_output( sink, cout_buf, ERROR_UNABLE_TO_OPEN_FILE );
+          }
+
+          if ( !vm.count("auto-config") )
+            ODIF::config_snapshot::check( ce, config );
+
+          co = po::parse_config_file(config_file, opts, true);
+
+          // keep the options to be stored (not the unregistered)
+          for ( vector<po::option>::iterator it=co.options.begin(); it!=co.options.end(); ++it )
+            if ( !it->unregistered )
+              for ( vector<string>::iterator vit=it->value.begin(); vit!=it->value.end(); ++vit )
+              {
+                ce.paths.push_back( it->string_key );
+                ce.paths.push_back( *vit );
+              }
+
+          snapshot.put( ck, ce );
         }
 
-        config_file.close();
+        po::store(co, vm);
       }
 
       po::notify(vm);
+
+      // external command limits
+      limits.timeout = std::max( timeout, 0 );
+      limits.cpu     = std::max( cpu_limit, 0 );
+      limits.mem     = std::max( mem_limit, 0 );
     }
     catch(po::required_option& e)
     {
       cerr << "ERROR: " << e.what() << endl;
-      exit( ERROR_IN_COMMAND_LINE );
+      exit_output( sink, cout_buf, ERROR_IN_COMMAND_LINE );
     }
     catch(po::error& e)
     {
       cerr << "ERROR: " << e.what() << endl;
-      exit( ERROR_IN_COMMAND_LINE );
+      exit_output( sink, cout_buf, ERROR_IN_COMMAND_LINE );
     }
 
 
@@ -510,6 +793,21 @@ main(int argc, char** argv)
 
       map<string,string> path_map;
 
+      // target directory results are kept in one place: with the project
+      // snapshot when it is used, else cached by makefile identity and
+      // content, so that the two cannot disagree.
+      ODIF::result_cache search_results;
+
+      if ( !snapshot.enabled() )
+      {
+        if ( search_cache.empty() )
+        {
+          string d = prefix_scripts ? output_prefix : auto_config;
+          search_cache = ( path( d.empty() ? "." : d ) / ".amu_search_cache" ).string();
+        }
+        search_results.set_path( search_cache );
+      }
+
       // check each scope identifier
       for ( vector<string>::iterator vit=scope_id.begin(); vit != scope_id.end(); ++vit)
       {
@@ -542,6 +840,27 @@ main(int argc, char** argv)
 
         debug_m(debug_filter, "scope: " + scope_name);
 
+        // use the result for this scope resolved by a previous run; the
+        // entry text is the makefile path when the makefile exists.
+        ODIF::config_snapshot::entry_s se;
+        const string sk = snap_key + "\nscope\n" + scmd + "\n" + lib_path;
+
+        if ( snapshot.get( sk, se ) )
+        {
+          if ( !se.text.empty() )
+          {
+            scope_id_mf.push_back( scope_name );
+            search_depends.push_back( se.text );
+          }
+
+          for ( vector<string>::iterator it=se.paths.begin(); it!=se.paths.end(); ++it )
+            path_map.insert( make_pair( *it, *it ) );
+
+          continue;
+        }
+
+        ODIF::config_snapshot::check( se, makefile_path.string() );
+
         // when makefile exists
         if ( exists(makefile_path) && is_regular_file(makefile_path) )
         {
@@ -550,13 +869,32 @@ main(int argc, char** argv)
           // save to list of scopes with makefile
           debug_m(debug_filter, "  recording scope identifier [" + scope_name + "] in scope-id-mf");
           scope_id_mf.push_back( scope_name );
+          search_depends.push_back( makefile_path.string() );
+          se.text = makefile_path.string();
 
           // run make to discover the target output directories
           string result;
           bool good=false;
 
-          debug_m(debug_filter, "  running: " + scmd );
-          UTIL::sys_command( scmd, result, good, false, true );
+          ostringstream key;
+          if ( search_results.enabled() )
+            key << scmd << "\n"
+                << UTIL::file_identity( makefile_path.string() ) << " "
+                << hex << UTIL::hash_file( makefile_path.string() ) << "\n"
+                << lib_path;
+
+          if ( search_results.enabled() && search_results.get( key.str(), result, good ) )
+          {
+            debug_m(debug_filter, "   cached: " + scmd );
+          }
+          else
+          {
+            debug_m(debug_filter, "  running: " + scmd );
+            UTIL::sys_command( scmd, result, good, false, true, limits );
+
+            if ( good )
+              search_results.put( key.str(), result, good );
+          }
 
           if ( good )
           {
@@ -566,7 +904,7 @@ main(int argc, char** argv)
           {
             debug_m(debug_filter, "    error: " + result, true );
 
-            // system command error, don't add directories.
+            // system command error, don't add (or save) directories.
             continue;
           }
 
@@ -580,12 +918,16 @@ main(int argc, char** argv)
           {
             path tp( *it );
 
+            ODIF::config_snapshot::check( se, tp.string() );
+
             debug_m(debug_filter, "  path [" + tp.string() + "] ", false);
             if ( exists(tp) && is_directory(tp) )
             { // add to include path map if it does not already exists
               if ( path_map.find(*it) == path_map.end() )
                 path_map.insert( make_pair( *it, tp.string() ) );
 
+              se.paths.push_back( tp.string() );
+
               debug_m(debug_filter, "exists.");
             }
             else
@@ -598,6 +940,8 @@ main(int argc, char** argv)
         {
           debug_m(debug_filter, "  makefile [" + makefile_path.string() + "] does not exists");
         }
+
+        snapshot.put( sk, se );
       }
 
       //
@@ -652,6 +996,9 @@ main(int argc, char** argv)
       debug_m(debug_filter, "auto-search: inactive.");
     }
 
+    // save configurations resolved by this run for later runs
+    snapshot.flush();
+
 
     ////////////////////////////////////////////////////////////////////////////
     // show configuration
@@ -712,6 +1059,21 @@ main(int argc, char** argv)
     scanner.set_config_prefix( auto_config );
     scanner.set_debug( vm.count("debug-scanner")>0 );
     scanner.set_debug_filter( debug_filter );
+    scanner.set_jobs( jobs > 0 ? jobs : 1 );
+    scanner.set_proc_limits( limits );
+    scanner.set_output_sink( &sink );
+    scanner.set_profile( profile );
+
+    // dependencies: input, configuration, searched makefiles, and files read
+    if ( depfile.length() )
+    {
+      scanner.set_depfile( depfile, output.length() ? output : input );
+
+      scanner.add_depend( input );
+      scanner.add_depend( config );
+      for ( vector<string>::iterator it=search_depends.begin(); it != search_depends.end(); ++it )
+        scanner.add_depend( *it );
+    }
 
     // configuration file
     scanner.set_rootscope( scope );
@@ -723,6 +1085,23 @@ main(int argc, char** argv)
     scanner.set_makefile_ext( makefile_ext );
     scanner.set_openscad_path( openscad_path );
     scanner.set_openscad_ext( openscad_ext );
+    scanner.set_openscad_cache( openscad_cache );
+
+    UTIL::copy_policy cp;
+    if ( !UTIL::copy_policy_parse( copy_policy, cp ) )
+    {
+      cerr << command_name << ": unknown copy-policy [" << copy_policy
+           << "], using [copy]." << endl;
+      cp = UTIL::copy_data;
+    }
+    scanner.set_copy_policy( cp );
+    scanner.set_copy_hash( copy_hash );
+    scanner.set_copy_threads( copy_threads > 0 ? copy_threads : 0 );
+
+    // without an output directory, keep no manifest by default
+    if ( copy_manifest.empty() && !doxygen_output.empty() )
+      copy_manifest = ( path(doxygen_output) / ".amu_copy_manifest" ).string();
+    scanner.set_copy_manifest( copy_manifest );
 
     // other
     scanner.set_scope_id_mf( scope_id_mf );
@@ -733,16 +1112,19 @@ main(int argc, char** argv)
     // process input file
     while( scanner.scan() != 0 )
       ;
+
+    // filter statistics
+    debug_stats( debug_filter, command_name );
   }
   catch(exception& e)
   {
     cerr << "Unhandled exception reached the top of main:" << endl
          << e.what() << "," << endl
          << "exiting..." << endl;
-    exit( ERROR_UNHANDLED_EXCEPTION );
+    exit_output( sink, cout_buf, ERROR_UNHANDLED_EXCEPTION );
   }
 
-  exit( SUCCESS );
+  exit_output( sink, cout_buf, SUCCESS );
 }
 
 //! @}
@@ -56,8 +56,13 @@ ODIF::ODIF_Scanner::ODIF_Scanner(const string& f, const string& s)
 
   // default operation
   scanner_output_on = true;
+  out_sink = NULL;
   debug_filter = false;
 
+  // copy asset data by default
+  copy_method = UTIL::copy_data;
+  copy_hash = false;
+
   // initialize variable map
   gevm.clear();
 
@@ -110,6 +115,13 @@ ODIF::ODIF_Scanner::ODIF_Scanner(const string& f, const string& s)
   start_file( f );
 }
 
+ODIF::ODIF_Scanner::~ODIF_Scanner(void)
+{
+  // stop external function co-processes
+  for ( map<string, ext_s>::iterator it=ext_m.begin(); it!=ext_m.end(); ++it )
+    delete it->second.cp;
+}
+
 void
 ODIF::ODIF_Scanner::update_gevm(void)
 {
@@ -136,17 +148,21 @@ ODIF::ODIF_Scanner::update_gevm(void)
 void
 ODIF::ODIF_Scanner::start_file( const string file )
 {
-  ifstream *ifs = new ifstream();
+  // read file through the input file cache
+  shared_ptr<const line_index> fli = include_files.share( file );
 
-  // open file stream
-  ifs->open( file.c_str() );
-
-  if ( !ifs->good() )
+  if ( !fli )
     abort( "unable to open input file", lineno(), file );
 
+  include_seen.insert( UTIL::hash_fnv1a(fli->buffer(), fli->buffer_size()) );
+
+  istream *ifs = new memory_istream( fli->buffer(), fli->buffer_size(), fli );
+
   // get canonical file path
   string file_path = bfs::canonical( bfs::path(file) ).string();
 
+  add_depend( file_path );
+
   // append to ${FILE_LIST}
   string list = gevm.expand( gevm.get_prefix() + "FILE_LIST" + gevm.get_suffix() );
   if ( list.length() ) list += " ";
@@ -177,12 +193,18 @@ ODIF::ODIF_Scanner::yywrap(void)
   if ( ifs_v.empty() )          // input stream vector empty
     return 1;
 
-  ifs_v.back().ifs->close();    // close current file
-  delete ifs_v.back().ifs;      // free storage
+  delete ifs_v.back().ifs;      // close current file
   ifs_v.pop_back();             // discard and get next stream
 
   if ( ifs_v.empty() )          // has last file has been closed?
+  {
+    defer_flush( true );        // write all deferred output
+    copy_flush();               // complete all asset copies
+    output_flush();             // write buffered output
+    profile_flush();            // write profile trace
+    depend_flush( true );       // write dependency file
     return 1;
+  }
 
   // update ${FILE_CURRENT}
   gevm.store( "FILE_CURRENT", ifs_v.back().name );
@@ -212,7 +234,176 @@ void
 ODIF::ODIF_Scanner::scanner_output( const char* buf, int size )
 {
   if (scanner_output_on) {
-    LexerOutput( buf, size );
+    if ( defer_q.empty() )
+      output_write( buf, size );
+    else
+      defer_q.back().text.append( buf, size );
+  }
+}
+
+void
+ODIF::ODIF_Scanner::defer_command(const string& c, const bool se, const bool rn,
+                                  const defer_fmt& f, const UTIL::proc_limits& l,
+                                  const string& u)
+{
+  defer_s d = { cmd_pool.submit( c, se, rn, l ), f, "", u };
+
+  defer_q.push_back( d );
+
+  // write any segments that have already completed
+  defer_flush( false );
+}
+
+size_t
+ODIF::ODIF_Scanner::cache_hits(void)
+{
+  return ( result_cache::get_hit_count() + file_cache::get_hit_count()
+         + get_regex_hit_count() + copy_manifest::get_skip_count() );
+}
+
+void
+ODIF::ODIF_Scanner::profile_flush(void)
+{
+  if ( !prof.enabled() )
+    return;
+
+  string name = gevm.expand( gevm.get_prefix() + "FILE_NAME" + gevm.get_suffix() );
+
+  if ( !prof.write( name ) )
+    cerr << ops << "unable to write profile: " << prof.trace_path( name ) << endl;
+
+  cerr << ops << "profile of " << name << ":" << endl;
+  prof.summary( cerr );
+
+  prof.set_path( "" );
+}
+
+void
+ODIF::ODIF_Scanner::add_depend(const string& f)
+{
+  if ( dep_file.empty() || f.empty() )
+    return;
+
+  boost::system::error_code ec;
+
+  if ( bfs::is_regular_file( f, ec ) )
+  {
+    bfs::path p = bfs::canonical( f, ec );
+
+    if ( !ec )
+      dep_set.insert( p.string() );
+  }
+}
+
+void
+ODIF::ODIF_Scanner::depend_flush(const bool good)
+{
+  if ( dep_file.empty() )
+    return;
+
+  if ( !good )
+    bfs::remove( dep_file );
+  else if ( !UTIL::depfile_write( dep_file, dep_target, dep_set ) )
+    cerr << ops << "unable to write dependency file: " << dep_file << endl;
+
+  dep_file.clear();
+}
+
+void
+ODIF::ODIF_Scanner::copy_flush(void)
+{
+  vector<copy_queue::copy_s> r;
+
+  copy_q.drain( r );
+
+  if ( r.empty() )
+    return;
+
+  for ( vector<copy_queue::copy_s>::iterator it=r.begin(); it!=r.end(); ++it )
+  {
+    if ( it->good )
+      copy_log.record( it->source, it->target, it->message );
+    else
+      error( it->message );
+  }
+
+  // copies may have created files
+  include_index.refresh();
+}
+
+string
+ODIF::ODIF_Scanner::run_command(const string& c, const bool se, const bool rn,
+                                const defer_fmt& f, const bool d,
+                                const UTIL::proc_limits* l, const string& u)
+{
+  const UTIL::proc_limits& pl = ( l != NULL ) ? *l : proc_limit;
+
+  if ( d && defer_ok() )
+  {
+    defer_command( c, se, rn, f, pl, u );
+
+    return( "" );
+  }
+
+  // command may use files of deferred commands
+  defer_barrier();
+
+  string r;
+  bool s = false;
+
+  UTIL::sys_command( c, r, s, se, rn, pl );
+
+  // command may have created files
+  include_index.refresh();
+
+  return( f( r, s ) );
+}
+
+UTIL::proc_limits
+ODIF::ODIF_Scanner::limits_option(const opt_values& ov, const size_t t,
+                                  const size_t c, const size_t m) const
+{
+  UTIL::proc_limits l = proc_limit;
+
+  if ( ov.found( t ) ) l.timeout = std::max( ov.num( t ), 0 );
+  if ( ov.found( c ) ) l.cpu = std::max( ov.num( c ), 0 );
+  if ( ov.found( m ) ) l.mem = std::max( ov.num( m ), 0 );
+
+  return( l );
+}
+
+bool
+ODIF::ODIF_Scanner::defer_uses(const string& f) const
+{
+  for ( deque<defer_s>::const_iterator it=defer_q.begin(); it!=defer_q.end(); ++it )
+    if ( it->file == f )
+      return( true );
+
+  return( false );
+}
+
+void
+ODIF::ODIF_Scanner::defer_flush(const bool all)
+{
+  while ( !defer_q.empty() )
+  {
+    defer_s& d = defer_q.front();
+
+    if ( !all && !cmd_pool.done( d.id ) )
+      break;
+
+    string r;
+    bool s = false;
+
+    cmd_pool.wait( d.id, r, s );
+    include_index.refresh();
+
+    string o = d.fmt( r, s );
+
+    output_write( o.c_str(), o.length() );
+    output_write( d.text.c_str(), d.text.length() );
+
+    defer_q.pop_front();
   }
 }
 
@@ -234,24 +425,38 @@ ODIF::ODIF_Scanner::error(const string& m, const int &n,
   scanner_output( "<tt>" + om + "</tt><br>\n" );
 
   if( a )
+  {
+    defer_flush( true );
+    copy_flush();
+    output_flush();
+    profile_flush();
+    depend_flush( false );
     LexerError( string(ops + "aborting...").c_str() );
+  }
   else
     return;
 }
 
 string
-ODIF::ODIF_Scanner::amu_error_msg(const string& m)
+ODIF::ODIF_Scanner::amu_error_loc(void)
 {
-  string om;
+  string ol;
 
-  om  = ops + "ERROR in "
+  ol  = ops + "ERROR in "
       + gevm.expand( gevm.get_prefix() + "FILE_CURRENT" + gevm.get_suffix() )
       + ", at line " + UTIL::to_string( lineno() );
 
   // delete command characters [\@] from parsed text to prevent them
   // from being interpreted by doxygen and/or the html browser.
-  om += ", near [" + UTIL::replace_chars( amu_parsed_text, "\\@" ) + "]"
-      +  ", " + m;
+  ol += ", near [" + UTIL::replace_chars( amu_parsed_text, "\\@" ) + "]";
+
+  return( ol );
+}
+
+string
+ODIF::ODIF_Scanner::amu_error_msg(const string& m, const string& l)
+{
+  string om = l + ", " + m;
 
   cerr << om << endl;
 
@@ -277,6 +482,12 @@ ODIF::ODIF_Scanner::fx_init(void)
 
   fx_qarg.clear();
 
+  fx_list.reset();
+  fx_arg_lists.clear();
+  fx_qarg_list.reset();
+  fx_arg_vars.clear();
+  fx_qarg_var.clear();
+
   fx_body_text.clear();
   fx_body_level = 0;
 
@@ -306,6 +517,10 @@ ODIF::ODIF_Scanner::fx_end(void)
 {
   fx_eline = lineno();
 
+  profiler::mark_s pm = { 0, 0, 0, 0 };
+  if ( prof.enabled() )
+    pm = prof.begin( cache_hits() );
+
   // prototype of build-in function: string function_name( void );
   typedef map< string, string (ODIF::ODIF_Scanner::*)(void) > function_table_type;
 
@@ -351,35 +566,39 @@ ODIF::ODIF_Scanner::fx_end(void)
   else
   {
     // not found in internal functions map, check in external function path
-    bfs::path exfx_path;
+    ext_s& ext = ext_lookup( fx_name );
+
+    if ( ext.state == ext_command || ext.state == ext_coprocess )
+    { // found and is a file
+      string args;
+
+      // append arguments
+      typedef vector<func_args::arg_term>::iterator fa_iter;
+      for ( fa_iter it=fx_argv.argv.begin()+1; it!=fx_argv.argv.end(); ++it ) {
+        args.append( " " );
+        if ( it->positional ) args.append( it->value );
+        else                  args.append( it->name + "=" + it->value );
+      }
 
-    exfx_path  = lib_path;
-    exfx_path /= "amu_ext";
-    exfx_path /= "amu_" + fx_name;
+      if ( ext.state == ext_command && defer_ok() )
+      { // run in worker pool, output when complete
+        const string error_loc = amu_error_loc();
 
-    // try file: <lib_path>/amu_ext/amu_<fx_name>
-    if ( bfs::exists( exfx_path ) )
-    {
-      if ( bfs::is_regular_file( exfx_path ) )
-      { // found and is a file
-        string scmd = exfx_path.string();
-
-        // append arguments
-        typedef vector<func_args::arg_term>::iterator fa_iter;
-        for ( fa_iter it=fx_argv.argv.begin()+1; it!=fx_argv.argv.end(); ++it ) {
-          scmd.append( " " );
-          if ( it->positional ) scmd.append( it->value );
-          else                  scmd.append( it->name + "=" + it->value );
-        }
+        result = run_command( ext.path + args, false, false,
+          [=] (string& r, bool s) -> string
+          { return( s ? r : amu_error_msg( r, error_loc ) ); } );
 
-        filter_debug( scmd );
-        UTIL::sys_command( scmd, result, success, false, false );
+        success = true;
       }
       else
       {
-        result = exfx_path.string() + " is not a regular file.";
+        ext_run( ext, args, result, success );
       }
     }
+    else if ( ext.state == ext_irregular )
+    {
+      result = ext.path + " is not a regular file.";
+    }
     else
     {
       // built-in not matched and external function does not exists
@@ -396,6 +615,15 @@ ODIF::ODIF_Scanner::fx_end(void)
     {
       gevm.store(fx_var, result);
 
+      // keep the words of a list result with the variable
+      if ( fx_list )
+      {
+        list_var_s lv = { gevm.generation(fx_var), fx_list };
+        list_vars[fx_var] = lv;
+      }
+      else
+        list_vars.erase(fx_var);
+
       filter_debug( fx_var + "=[" + result + "]" );
     }
   }
@@ -404,11 +632,122 @@ ODIF::ODIF_Scanner::fx_end(void)
     scanner_output( amu_error_msg(result) );
   }
 
+  if ( prof.enabled() )
+    prof.end( pm, "amu_" + fx_name, get_input_name(false), fx_bline,
+              result.size(), cache_hits() );
+
   // output blank lines to maintain file length when functions are
   // broken across multiple lines (don't begin and end on the same line).
   for(size_t i=fx_bline; i<fx_eline; i++) scanner_output("\n");
 }
 
+ODIF::ODIF_Scanner::ext_s&
+ODIF::ODIF_Scanner::ext_lookup(const string& n)
+{
+  map<string, ext_s>::iterator it = ext_m.find( n );
+
+  if ( it != ext_m.end() )
+    return ( it->second );
+
+  // file: <lib_path>/amu_ext/amu_<n>
+  bfs::path exfx_path;
+
+  exfx_path  = lib_path;
+  exfx_path /= "amu_ext";
+  exfx_path /= "amu_" + n;
+
+  ext_s e;
+
+  e.path = exfx_path.string();
+  e.state = ext_missing;
+  e.cp = NULL;
+
+  if ( bfs::exists( exfx_path ) )
+  {
+    if ( bfs::is_regular_file( exfx_path ) )
+    {
+      e.state = ext_command;
+
+      // functions that support the co-process protocol are marked in
+      // their header with the line: "## amu_ext: coprocess"
+      ifstream ifs( e.path.c_str() );
+      string line;
+
+      for ( int i=0; i<64 && getline(ifs, line); ++i )
+      {
+        if ( line.compare(0, 21, "## amu_ext: coprocess") == 0 )
+        {
+          e.state = ext_coprocess;
+          break;
+        }
+      }
+    }
+    else
+    {
+      e.state = ext_irregular;
+    }
+  }
+
+  return ( ext_m[ n ] = e );
+}
+
+void
+ODIF::ODIF_Scanner::ext_run(ext_s& e, const string& a, string& r, bool& s)
+{
+  // function may use files of deferred commands
+  defer_barrier();
+
+  if ( e.state == ext_coprocess )
+  {
+    // start once and reuse for the remainder of the run.
+    if ( e.cp == NULL )
+    {
+      e.cp = new coprocess;
+      e.cp->set_timeout( proc_limit.timeout );
+
+      filter_debug( e.path + " --amu-coprocess (start)" );
+      if ( !e.cp->start( e.path, "--amu-coprocess" ) )
+        e.state = ext_command;
+    }
+
+    if ( e.state == ext_coprocess )
+    {
+      int status;
+      if ( e.cp->request( a, r, status ) )
+      {
+        filter_debug( e.path + a + " (co-process)" );
+        s = ( status == 0 );
+      }
+      else
+      {
+        // the request may have been partly carried out; report it rather
+        // than repeat it, and use a command per call from now on.
+        if ( e.cp->timed_out() )
+          r = "co-process exceeded time limit of "
+            + UTIL::to_string( proc_limit.timeout ) + " seconds: " + e.path + a;
+        else
+          r = "co-process protocol failure in " + e.path + a;
+        s = false;
+
+        e.state = ext_command;
+      }
+
+      // command may have created files
+      include_index.refresh();
+
+      return;
+    }
+  }
+
+  string scmd = e.path + a;
+
+  filter_debug( scmd );
+  UTIL::sys_command( scmd, r, s, false, false, proc_limit );
+
+  // command may have created files
+  include_index.refresh();
+}
+
 void
 ODIF::ODIF_Scanner::fx_set_var(void)
 {
@@ -425,6 +764,21 @@ ODIF::ODIF_Scanner::fx_set_arg_name(void)
   fx_argv.set_next_name( mt.substr(0,mt.length()-1) );
 }
 
+void
+ODIF::ODIF_Scanner::fx_store_arg_expanded(void)
+{
+  const string t = YYText();
+
+  fx_argv.store( levm.expand( t ) );
+
+  // variable name without '${' and '}' (see id_var in lexer).
+  fx_arg_vars[ fx_argv.size() - 1 ] = t.substr(2, t.length()-3);
+
+  shared_ptr<const word_list> l = fx_var_list( t );
+  if ( l )
+    fx_arg_lists[ fx_argv.size() - 1 ] = l;
+}
+
 void
 ODIF::ODIF_Scanner::fx_store_arg_escaped(void)
 {
@@ -433,6 +787,42 @@ ODIF::ODIF_Scanner::fx_store_arg_escaped(void)
   fx_argv.store( mt.substr(levm.get_escape_prefix_length(),mt.length()) );
 }
 
+void
+ODIF::ODIF_Scanner::fx_store_qarg(void)
+{
+  fx_argv.store( fx_qarg );
+
+  // a variable applies when only the closing quote followed it.
+  if ( !fx_qarg_var.empty() && fx_qarg.length() == fx_qarg_list_end + 1 )
+  {
+    fx_arg_vars[ fx_argv.size() - 1 ] = fx_qarg_var;
+
+    if ( fx_qarg_list )
+      fx_arg_lists[ fx_argv.size() - 1 ] = fx_qarg_list;
+  }
+
+  fx_qarg_list.reset();
+  fx_qarg_var.clear();
+  fx_qarg.clear();
+}
+
+void
+ODIF::ODIF_Scanner::fx_app_qarg_expanded(void)
+{
+  // a list value applies when only the opening quote precedes it.
+  const bool first = ( fx_qarg.length() == 1 );
+  const string t = YYText();
+
+  fx_qarg+=levm.expand( t );
+
+  if ( first )
+  {
+    fx_qarg_var = t.substr(2, t.length()-3);
+    fx_qarg_list = fx_var_list( t );
+    fx_qarg_list_end = fx_qarg.length();
+  }
+}
+
 void
 ODIF::ODIF_Scanner::fx_app_qarg_escaped(void)
 {
@@ -441,6 +831,114 @@ ODIF::ODIF_Scanner::fx_app_qarg_escaped(void)
   fx_qarg+=mt.substr(levm.get_escape_prefix_length(),mt.length());
 }
 
+/***************************************************************************//**
+
+  \details
+
+    The list functions (\c seq, \c foreach, \c word, and \c combine)
+    keep the word positions of a result that is stored to a variable.
+    When a later function argument is exactly that variable, either
+    alone or alone within quotes, and the variable has not since been
+    changed, the function uses the kept words rather than splitting the
+    argument text again. The words are used only when splitting the
+    text with the tokenizer of the function would give the same list,
+    so the result does not depend on the kept words. Only the word
+    positions are kept with the variable; the text is held once, by the
+    variable map.
+
+    A function that splits a lone variable argument itself, such as
+    \c word, keeps the words with the variable in the same way, so that
+    selecting from the same variable in successive calls does not split
+    or hash its value again.
+
+*******************************************************************************/
+shared_ptr<const ODIF::word_list>
+ODIF::ODIF_Scanner::fx_var_list(const string& v)
+{
+  // variable name without '${' and '}' (see id_var in lexer).
+  map<string, list_var_s>::const_iterator
+    it = list_vars.find( v.substr(2, v.length()-3) );
+
+  if ( it == list_vars.end() || levm.generation( it->first ) != it->second.gen )
+    return( shared_ptr<const word_list>() );
+
+  return( it->second.list );
+}
+
+bool
+ODIF::ODIF_Scanner::fx_arg_list(const string* v, const string& d, bool s,
+                                word_list& l)
+{
+  if ( v == NULL )
+    return( false );
+
+  // locate argument by its value.
+  size_t ai = 0;
+  while ( ai < fx_argv.argv.size() && &fx_argv.argv[ai].value != v )
+    ++ai;
+
+  map<size_t, shared_ptr<const word_list> >::const_iterator
+    it = fx_arg_lists.find( ai );
+
+  if ( it == fx_arg_lists.end() )
+    return( false );
+
+  if ( !it->second->splits_as( d, s ) )
+    return( false );
+
+  // the value is the list text, alone or within quotes, and is used
+  // as the function would unquote it.
+  const size_t n = it->second->length();
+  size_t b = 0;
+
+  if ( v->length() == n + 2 )
+    b = 1;
+  else if ( v->length() != n )
+    return( false );
+  else
+  {
+    size_t fc = 0, lc = n;
+    while ( fc < n && isspace( static_cast<unsigned char>((*v)[fc]) ) ) ++fc;
+    while ( lc > fc && isspace( static_cast<unsigned char>((*v)[lc-1]) ) ) --lc;
+
+    // text that unquotes to less
+    if ( lc - fc > 1 && ((*v)[fc] == '"' || (*v)[fc] == '\'') && (*v)[lc-1] == (*v)[fc] )
+      return( false );
+  }
+
+  l.bind( *it->second, v->data() + b );
+
+  return( true );
+}
+
+void
+ODIF::ODIF_Scanner::fx_keep_arg_list(const size_t ai, const size_t b,
+                                     const word_list& l)
+{
+  map<size_t, string>::const_iterator it = fx_arg_vars.find( ai );
+
+  if ( it == fx_arg_vars.end() || ai >= fx_argv.argv.size() )
+    return;
+
+  const string* v = &fx_argv.argv[ai].value;
+
+  // the words must be of the whole value, alone or within quotes, as
+  // fx_arg_list() binds them.
+  if ( !( b == 0 && l.length() == v->length() ) &&
+       !( b == 1 && l.length() + 2 == v->length() ) )
+    return;
+
+  const size_t g = levm.generation( it->second );
+  if ( g == 0 )
+    return;
+
+  shared_ptr<word_list> k = make_shared<word_list>();
+  k->bind( l, NULL );
+
+  list_var_s lv = { g, k };
+  list_vars[ it->second ] = lv;
+}
+
 /***************************************************************************//**
 
   \details
@@ -603,14 +1101,13 @@ ODIF::ODIF_Scanner::undef_end(void)
 {
   undef_eline = lineno();
 
-  string var_list = UTIL::unquote_trim( undef_text );
-  size_t var_count = UTIL::word_count( var_list );
+  // split the list once (see UTIL::get_word)
+  word_list var_list( UTIL::unquote_trim( undef_text ), " \f\n\r\t\v" );
 
   // remove each named variable from the global map
-  // get_word: words are numbered starting from 1.
-  for (size_t i=1; i<=var_count; i++)
+  for (size_t i=0; i<var_list.size(); i++)
   {
-    string v = UTIL::unquote_trim( UTIL::get_word( var_list, i ) );
+    string v = UTIL::unquote_trim( var_list[i] );
 
     if ( gevm.exists( v ) )
     {
@@ -934,6 +1431,13 @@ ODIF::ODIF_Scanner::if_set_var(void)
      copy       | c   | copy the file contents to the output
      no_switch  | n   | do not switch the input stream
      search     | s   | search include paths for file
+     once       | o   | skip file when its contents were input before
+
+    Input files are read once per run and cached in memory, so a file
+    included by many others is not re-read for each inclusion. With \c
+    once, a file is skipped when a file with identical contents has
+    already been input or copied (including the root file), similar
+    to an include guard.
 
     The options change the commands default behavior and are useful
     during development and debugging. When using these options, they
@@ -962,6 +1466,7 @@ ODIF::ODIF_Scanner::inc_init(void)
   inc_copy = false;
   inc_switch = true;
   inc_search = false;
+  inc_once = false;
 
   inc_bline = lineno();
 }
@@ -971,6 +1476,13 @@ ODIF::ODIF_Scanner::inc_end(void)
 {
   inc_eline = lineno();
 
+  // file may be written by deferred commands
+  defer_barrier();
+
+  profiler::mark_s pm = { 0, 0, 0, 0 };
+  if ( prof.enabled() )
+    pm = prof.begin( cache_hits() );
+
   // unquote and expand variables in argument text
   string file_arg = levm.expand_text( UTIL::unquote_trim( inc_text ) );
 
@@ -989,26 +1501,44 @@ ODIF::ODIF_Scanner::inc_end(void)
     file_inc = file_arg;
   }
 
-  // copy file to output
-  if ( inc_copy )
+  // skip files with contents that have already been input
+  bool skip = false;
+
+  if ( inc_once )
   {
-    ifstream ifs( file_inc.c_str() );
+    const line_index* fli = include_files.get( file_inc );
 
-    if ( ! ifs.is_open() )
+    if ( fli == NULL )
       abort( "unable to read file" , lineno(), file_arg );
 
-    string line;
-    while ( !ifs.eof() )
-    {
-      getline( ifs, line );
-      scanner_output( line + "\n" );
-    }
+    skip = include_seen.count
+           ( UTIL::hash_fnv1a(fli->buffer(), fli->buffer_size()) ) != 0;
 
-    ifs.close();
+    if ( skip )
+      filter_debug( "once: skipping " + file_inc );
   }
 
+  // copy file to output (each line with a newline)
+  if ( inc_copy && !skip )
+  {
+    const line_index* fli = include_files.get( file_inc );
+
+    if ( fli == NULL )
+      abort( "unable to read file" , lineno(), file_arg );
+
+    scanner_output( fli->buffer(), fli->buffer_size() );
+    scanner_output( "\n", 1 );
+
+    include_seen.insert( UTIL::hash_fnv1a(fli->buffer(), fli->buffer_size()) );
+  }
+
+  if ( prof.enabled() )
+    prof.end( pm, "amu_include", get_input_name(false), inc_bline,
+              inc_copy && !skip ? include_files.get( file_inc )->buffer_size() : 0,
+              cache_hits() );
+
   // switch stream to file
-  if ( inc_switch )
+  if ( inc_switch && !skip )
     start_file( file_inc );
 
   // output blank lines to maintain file length when definitions are
@@ -1135,6 +1665,9 @@ ODIF::ODIF_Scanner::file_rl(
   const bool& rid
 )
 {
+  // file may be written by deferred commands
+  defer_barrier();
+
   bfs::path file_path ( file );
   bfs::path file_found;
 
@@ -1155,7 +1688,7 @@ ODIF::ODIF_Scanner::file_rl(
       bfs::path p = *it / file_path;              // full file-path
 
       filter_debug(" checking-path: " + p.string(), false, false, false);
-      if ( exists(p) && is_regular_file(p) )
+      if ( include_index.is_file(p) )
       {
         found = true;
         file_found = p;
@@ -1176,7 +1709,7 @@ ODIF::ODIF_Scanner::file_rl(
       bfs::path p = *it / file_path.filename();   // filename only
 
       filter_debug(" checking-file: " + p.string(), false, false, false);
-      if ( exists(p) && is_regular_file(p) )
+      if ( include_index.is_file(p) )
       {
         found = true;
         file_found = p;
@@ -1197,6 +1730,8 @@ ODIF::ODIF_Scanner::file_rl(
 
     filter_debug(" found [" + file_found.string() + "]", false, false, false);
 
+    add_depend( file_found.string() );
+
     //
     // format output not specified, disabled
     //
@@ -1259,32 +1794,25 @@ ODIF::ODIF_Scanner::file_rl(
 
         filter_debug(" target [" + target.string() + "]", false, false, false);
 
-        bool copy_needed = true;
-
-        // skip copy when file of same size exists.
-        if ( exists(target) && is_regular_file(target) )
+        // skip copy when target is an up-to-date copy of source.
+        if ( copy_log.current( source.string(), target.string(), copy_hash ) )
         {
-          if ( bfs::file_size( source ) == bfs::file_size( target ) )
-          {
-            copy_needed = false;
-
-            filter_debug("  same sized target exists.", false, false, false);
-          }
-          else
-          { // differ in size, remove.
-            bfs::remove( target );
-          }
+          filter_debug("  up-to-date target exists.", false, false, false);
         }
 
         // could skip copy when source path is sub-directory of output path
         // ie: (outpath / get_relative_path(source, outpath) == source)
 
-        if ( copy_needed )
+        else
         {
-          // copy source to target
-          bfs::copy_file( source, target, bfs::copy_option::overwrite_if_exists );
+          // copy source to target (in background when threads > 0)
+          if ( copy_q.submit( source.string(), target.string(), copy_method ) )
+            filter_debug(" copy queued.", false, false, false);
+          else
+            filter_debug(" copy already queued.", false, false, false);
 
-          filter_debug(" copy done.", false, false, false);
+          if ( copy_q.get_threads() == 0 )
+            copy_flush();
         }
 
         // remake return reference to target path relative to parent outpath
@@ -41,6 +41,8 @@
 
 #include <fstream>
 #include <stack>
+#include <deque>
+#include <functional>
 // #include <iostream>
 // #include <sstream>
 // #include <string>
@@ -68,7 +70,7 @@ class ODIF_Scanner : public yyFlexLexer{
     //! \param s  scanner output prefix text string.
     ODIF_Scanner(const std::string& f, const std::string& s="openscad-dif: ");
     //! scanner destructor.
-    ~ODIF_Scanner(void) { }
+    ~ODIF_Scanner(void);
 
     // must call before calling scan().
     //! update environment variable map.
@@ -183,18 +185,81 @@ class ODIF_Scanner : public yyFlexLexer{
     //! get the file extension used for OpenSCAD files.
     std::string get_openscad_ext(void) { return openscad_ext; }
 
+    //! set the OpenSCAD result cache path (empty to disable).
+    void set_openscad_cache(const std::string& s) { openscad_cache.set_path( s ); }
+    //! get the OpenSCAD result cache path.
+    std::string get_openscad_cache(void) { return openscad_cache.get_path(); }
+
+    //! set the method used to copy assets to the output.
+    void set_copy_policy(const UTIL::copy_policy p) { copy_method = p; }
+    //! get the method used to copy assets to the output.
+    UTIL::copy_policy get_copy_policy(void) { return copy_method; }
+
+    //! set whether to compare content hashes of asset copies.
+    void set_copy_hash(bool f) { copy_hash = f; }
+    //! get whether to compare content hashes of asset copies.
+    bool get_copy_hash(void) { return copy_hash; }
+
+    //! set the number of background asset copy threads (zero to disable).
+    void set_copy_threads(const size_t n) { copy_q.set_threads( n ); }
+    //! get the number of background asset copy threads.
+    size_t get_copy_threads(void) { return copy_q.get_threads(); }
+
+    //! set the asset copy manifest file path (empty to disable).
+    void set_copy_manifest(const std::string& s) { copy_log.set_path( s ); }
+    //! get the asset copy manifest file path.
+    std::string get_copy_manifest(void) { return copy_log.get_path(); }
+
+    //! return number of compiled regular expression cache hits.
+    static size_t get_regex_hit_count(void);
+    //! return number of compiled regular expression cache misses.
+    static size_t get_regex_miss_count(void);
+
+    //! set the dependency file path and target name (empty to disable).
+    void set_depfile(const std::string& f, const std::string& t)
+      { dep_file = f; dep_target = t; }
+    //! get the dependency file path.
+    std::string get_depfile(void) { return dep_file; }
+    //! record the existing file f as a dependency of the output.
+    void add_depend(const std::string& f);
+
+    //! set the profile trace file path (empty to disable).
+    void set_profile(const std::string& s) { prof.set_path( s ); }
+    //! get the profile trace file path.
+    std::string get_profile(void) { return prof.get_path(); }
+
+    //! set the default limits of external commands.
+    void set_proc_limits(const UTIL::proc_limits& l) { proc_limit = l; }
+    //! get the default limits of external commands.
+    UTIL::proc_limits get_proc_limits(void) { return proc_limit; }
+
+    //! set the output buffer for scanner output (NULL for the lexer output).
+    void set_output_sink(output_sink* s) { out_sink = s; }
+
+    //! set the maximum number of concurrent external commands.
+    void set_jobs(const size_t n) { cmd_pool.set_jobs( n ); }
+    //! get the maximum number of concurrent external commands.
+    size_t get_jobs(void) { return cmd_pool.get_jobs(); }
+
   private:
   //////////////////////////////////////////////////////////////////////////////
   // scanner private
   //////////////////////////////////////////////////////////////////////////////
     bool scanner_output_on;                 //!< scanner output on.
+    output_sink* out_sink;                  //!< scanner output buffer.
+    profiler prof;                          //!< function call profiler.
+    UTIL::proc_limits proc_limit;           //!< default command limits.
+
+    std::string dep_file;                   //!< dependency file path.
+    std::string dep_target;                 //!< dependency file target.
+    std::set<std::string> dep_set;          //!< files the output depends on.
     bool debug_filter;                      //!< filter debugging output.
 
     std::string ops;                        //!< output prefix string.
 
     struct ifs_s {                          //!< input file structure.
       std::string   name;                   //!< file name.
-      std::ifstream *ifs;                   //!< file stream pointer.
+      std::istream  *ifs;                   //!< file stream pointer.
       int           line;                   //!< file line number.
     };
 
@@ -212,6 +277,11 @@ class ODIF_Scanner : public yyFlexLexer{
     bool prefix_scripts;                    //!< prefixing extracted scripts?
 
     std::vector<std::string> include_path;  //!< vector of include paths.
+    dir_index   include_index;              //!< include path directory index.
+    file_cache  file_lines;                 //!< amu_file mapped file cache.
+    file_cache  include_files;              //!< input and include file cache.
+    word_list_cache word_lists;             //!< amu_word split word lists.
+    std::set<uint64_t> include_seen;        //!< content hashes of input files.
 
     std::string doxygen_output;             //!< doxygen output rootpath.
     std::string html_output;                //!< html output path.
@@ -226,6 +296,13 @@ class ODIF_Scanner : public yyFlexLexer{
     std::string makefile_ext;               //!< makefile extension.
     std::string openscad_ext;               //!< OpenSCAD extension.
 
+    result_cache openscad_cache;            //!< OpenSCAD in-line script result cache.
+
+    UTIL::copy_policy copy_method;          //!< asset copy method.
+    bool copy_hash;                         //!< compare asset content hashes.
+    copy_manifest copy_log;                 //!< asset copy manifest.
+    copy_queue  copy_q;                     //!< asset copy queue.
+
   //////////////////////////////////////////////////////////////////////////////
   // general
   //////////////////////////////////////////////////////////////////////////////
@@ -239,6 +316,21 @@ class ODIF_Scanner : public yyFlexLexer{
     void scanner_output(const std::string& s) { scanner_output( s.c_str(), s.length() ); }
     //! write the first size characters of buf to the scanner output.
     void scanner_output(const char* buf, int size);
+    //! write the first size characters of buf to the output (not deferred).
+    void output_write(const char* buf, const size_t size)
+    {
+      if ( out_sink != NULL ) out_sink->write( buf, size );
+      else                    LexerOutput( buf, size );
+    }
+    //! return the total cache hit count (for profiling).
+    static size_t cache_hits(void);
+    //! write the profile trace and summary.
+    void profile_flush(void);
+    //! write the dependency file (or remove it when not good).
+    void depend_flush(const bool good);
+
+    //! write buffered output at a flush point.
+    void output_flush(void) { if ( out_sink != NULL ) out_sink->flush(); }
     //! copy to entire lexed text (yytext) to the scanner output.
     void scanner_echo(void) { scanner_output( YYText(), YYLeng() ); }
 
@@ -250,7 +342,65 @@ class ODIF_Scanner : public yyFlexLexer{
                const std::string &t = "") { error(m, n, t, true); }
 
     //! generate standard error message string with message m.
-    std::string amu_error_msg(const std::string& m);
+    std::string amu_error_msg(const std::string& m)
+                              { return amu_error_msg( m, amu_error_loc() ); }
+    //! generate standard error message string with message m at location l.
+    std::string amu_error_msg(const std::string& m, const std::string& l);
+    //! generate error location string for the current parsed text.
+    std::string amu_error_loc(void);
+
+  //////////////////////////////////////////////////////////////////////////////
+  // deferred output
+  //////////////////////////////////////////////////////////////////////////////
+    //! formatter of a deferred command output r with command status s.
+    typedef std::function<std::string (std::string& r, bool s)> defer_fmt;
+
+    struct defer_s {                    //!< deferred output segment.
+      size_t        id;                 //!< command pool identifier.
+      defer_fmt     fmt;                //!< command output formatter.
+      std::string   text;               //!< scanner output following command.
+      std::string   file;               //!< file in use until command completes.
+    };
+
+    command_pool        cmd_pool;       //!< external command worker pool.
+    std::deque<defer_s> defer_q;        //!< deferred output segments.
+
+    //! \brief test if the output of the current function may be deferred.
+    //! \details not while profiling, which records the time and output
+    //!          of each call when it returns.
+    bool defer_ok(void) { return ( cmd_pool.get_jobs() > 1 && fx_var.empty()
+                                   && !debug_filter && scanner_output_on
+                                   && !prof.enabled() ); }
+    //! start command c under limits l and defer its output, formatted by f.
+    void defer_command(const std::string& c, const bool se, const bool rn,
+                       const defer_fmt& f, const UTIL::proc_limits& l,
+                       const std::string& u);
+    //! \brief run command c and return its output formatted by f.
+    //! \details when d and the output may be deferred, the command is
+    //!          started in the worker pool and an empty string returned;
+    //!          otherwise, all deferred commands are first waited for.
+    //!          The command runs under limits l, or else the defaults.
+    //!          A deferred command keeps file u in use until complete.
+    std::string run_command(const std::string& c, const bool se, const bool rn,
+                            const defer_fmt& f, const bool d=true,
+                            const UTIL::proc_limits* l=NULL,
+                            const std::string& u="");
+    //! \brief return the process limits of options t, c, and m of ov.
+    //! \details limits not specified take the default; zero disables.
+    UTIL::proc_limits limits_option(const opt_values& ov, const size_t t,
+                                    const size_t c, const size_t m) const;
+    //! write completed deferred segments (all: wait for each) in order.
+    void defer_flush(const bool all);
+    //! \brief wait for all deferred commands.
+    //! \details called before a command is run sequentially and before
+    //!          files are located or read, which earlier commands may
+    //!          still be writing.
+    void defer_barrier(void) { defer_flush( true ); }
+    //! test if file f is in use by a deferred command.
+    bool defer_uses(const std::string& f) const;
+
+    //! wait for queued asset copies, record them, and report errors.
+    void copy_flush(void);
 
   //////////////////////////////////////////////////////////////////////////////
   // amu parsed text
@@ -272,6 +422,23 @@ class ODIF_Scanner : public yyFlexLexer{
 
     std::string fx_qarg;                //!< parsed amu quoted argument string.
 
+    //! list value of a variable, as stored by a list function.
+    struct list_var_s {
+      size_t    gen;                    //!< variable value generation.
+      std::shared_ptr<const word_list> list;  //!< words (text released).
+    };
+
+    std::map<std::string, list_var_s> list_vars;  //!< list values by variable name.
+    std::shared_ptr<word_list> fx_list; //!< list value of the function result.
+    std::map<size_t, std::shared_ptr<const word_list> >
+                fx_arg_lists;           //!< list values of arguments by position.
+    std::shared_ptr<const word_list>
+                fx_qarg_list;           //!< list value of the quoted argument.
+    size_t      fx_qarg_list_end;       //!< quoted argument length after its list value.
+    std::map<size_t, std::string>
+                fx_arg_vars;            //!< variable of lone variable arguments by position.
+    std::string fx_qarg_var;            //!< variable of the quoted argument.
+
     std::string fx_body_text;           //!< parsed amu function body text.
     size_t      fx_body_level;          //!< body text nested brace pair level.
 
@@ -297,18 +464,18 @@ class ODIF_Scanner : public yyFlexLexer{
     //! store the current parsed text the function argument.
     void fx_store_arg(void) { fx_argv.store( YYText() ); }
     //! expand parsed variable and store to the function argument.
-    void fx_store_arg_expanded(void) { fx_argv.store( levm.expand( YYText() ) ); }
+    void fx_store_arg_expanded(void);
     //! remove escaping in the escaped-parsed variable and store to the function argument.
     void fx_store_arg_escaped(void);
 
     //! store and clear the current quoted argument string.
-    void fx_store_qarg(void) { fx_argv.store( fx_qarg ); fx_qarg.clear(); }
+    void fx_store_qarg(void);
     //! append the string s to the quoted argument string.
     void fx_app_qarg(const std::string &s) { fx_qarg+=s; }
     //! append the current matched text to the quoted argument string.
     void fx_app_qarg(void) { fx_qarg+=YYText(); }
     //! expand parsed variable and append to the quoted argument string.
-    void fx_app_qarg_expanded(void) { fx_qarg+=levm.expand( YYText() ); }
+    void fx_app_qarg_expanded(void);
     //! remove escaping in the escaped-parsed variable and append to the quoted argument string.
     void fx_app_qarg_escaped(void);
 
@@ -320,6 +487,41 @@ class ODIF_Scanner : public yyFlexLexer{
     //! increment or decrement variable with post or pre assignment.
     void fx_incr_arg(bool post=true);
 
+    //! return the current list value of the parsed variable v, else null.
+    std::shared_ptr<const word_list> fx_var_list(const std::string& v);
+    //! \brief get the list value of a function argument.
+    //! \param v  argument value (of fx_argv).
+    //! \param d  tokenizer the function would split the value with.
+    //! \param s  the function would trim the words.
+    //! \param l  list bound to the unquoted argument value.
+    //! \returns  \b true when the argument is the list value of a
+    //!           variable that splits as \p d with \p s.
+    bool fx_arg_list(const std::string* v, const std::string& d, bool s,
+                     word_list& l);
+    //! \brief keep the words of a function argument with its variable.
+    //! \param ai index of the argument in fx_argv.
+    //! \param b  position in the argument value of the text \p l was
+    //!           split from.
+    //! \param l  words of the unquoted argument value.
+    void fx_keep_arg_list(const size_t ai, const size_t b,
+                          const word_list& l);
+
+    //! external function lookup states.
+    enum ext_state { ext_missing, ext_irregular, ext_command, ext_coprocess };
+
+    struct ext_s {                      //!< external function lookup.
+      std::string   path;               //!< function file path.
+      ext_state     state;              //!< function lookup state.
+      coprocess     *cp;                //!< running co-process or NULL.
+    };
+
+    std::map<std::string, ext_s> ext_m; //!< external function lookup cache.
+
+    //! lookup (once) the external function for function name n.
+    ext_s& ext_lookup(const std::string& n);
+    //! run external function e with argument text a.
+    void ext_run(ext_s& e, const std::string& a, std::string& r, bool& s);
+
   //////////////////////////////////////////////////////////////////////////////
   // amu_define
   //////////////////////////////////////////////////////////////////////////////
@@ -431,6 +633,7 @@ class ODIF_Scanner : public yyFlexLexer{
     bool        inc_copy;               //!< include output state variable.
     bool        inc_switch;             //!< include behavior state variable.
     bool        inc_search;             //!< include behavior state variable.
+    bool        inc_once;               //!< include behavior state variable.
 
     size_t      inc_bline;              //!< beginning line of include.
     size_t      inc_eline;              //!< ending line of include.
@@ -451,6 +654,8 @@ class ODIF_Scanner : public yyFlexLexer{
     void inc_set_switch(bool s) { inc_switch=s; }
     //! set include behavior state variable.
     void inc_set_search(bool s) { inc_search=s; }
+    //! set include behavior state variable.
+    void inc_set_once(bool s) { inc_once=s; }
 
   //////////////////////////////////////////////////////////////////////////////
   // nested comment block
@@ -507,11 +712,6 @@ class ODIF_Scanner : public yyFlexLexer{
   // openscad_dif_scanner_bif3.cpp
     //! combine each element from each set to form all possible word combinations.
     std::string bif_combine(void);
-    //! recursive helper function for \ref bif_combine.
-    void bif_combineR( std::string &r, std::vector<std::string> sv,
-                       const std::string &p, const std::string &s,
-                       const std::string &j, const std::string &ws,
-                       const std::string &t );
     //! perform search and replace on text.
     std::string bif_replace(void);
     //! count or select words from a list.
@@ -31,7 +31,6 @@
 *******************************************************************************/
 
 #include "openscad_dif_scanner.hpp"
-#include <set>
 
 // #include <boost/filesystem.hpp>
 
@@ -144,6 +143,15 @@ ODIF::ODIF_Scanner::bif_eval(void)
       stderr | s   | false   | capture standard error output
       rmnl   | r   | true    | remove line-feeds / carriage returns
       eval   | e   | false   | expand variables in text
+      timeout| to  | 0       | wall-clock time limit in seconds
+      cpu    | cpu | 0       | processor time limit in seconds
+      mem    | mem | 0       | address space limit in MiB
+
+    A limit of zero means no limit. When a limit is not specified, the
+    value set on the command line (see \c --timeout, \c --cpu-limit,
+    and \c --mem-limit) is used. A command that exceeds a limit is
+    terminated, together with any processes it has started, and an
+    error is reported in its place.
 
     For more information on how to specify and use function arguments
     see \ref openscad_dif_sm_a.
@@ -152,45 +160,32 @@ ODIF::ODIF_Scanner::bif_eval(void)
 string
 ODIF::ODIF_Scanner::bif_shell(void)
 {
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_stderr, o_rmnl, o_eval, o_timeout, o_cpu, o_mem };
+  static constexpr opt_decl od[] =
   {
-  "stderr",   "s",
-  "rmnl",     "r",
-  "eval",     "e"
+  { "stderr",   "s",    opt_flag,   "0" },
+  { "rmnl",     "r",    opt_flag,   "1" },
+  { "eval",     "e",    opt_flag,   "0" },
+  { "timeout",  "to",   opt_int,    "0" },
+  { "cpu",      "cpu",  opt_int,    "0" },
+  { "mem",      "mem",  opt_int,    "0" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // declare and assign flag defaults
-  size_t ap=0;
-  bool flag_stde = false; ap+=2;
-  bool flag_rmnl = true;  ap+=2;
-  bool flag_eval = false; ap+=2;
-
-  // generate options help string.
-  string help = "flags: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od, "flags", opt_schema::last );
+  const string& help = os.help();
 
-  // assign local variable flags:
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-  {
-    bool found;
-
-    if      (!(it->compare(vana[0])&&it->compare(vana[1])))
-      flag_stde=( atoi(fx_argv.arg(*it, found).c_str()) > 0 );
-    else if (!(it->compare(vana[2])&&it->compare(vana[3])))
-      flag_rmnl=( atoi(fx_argv.arg(*it, found).c_str()) > 0 );
-    else if (!(it->compare(vana[4])&&it->compare(vana[5])))
-      flag_eval=( atoi(fx_argv.arg(*it, found).c_str()) > 0 );
-    else
-      return( amu_error_msg(*it + " invalid flag. " + help) );
-  }
+  // parse named arguments.
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid flag. " + help) );
+
+  // assign local variable flags.
+  bool flag_stde = ov.flag( o_stderr );
+  bool flag_rmnl = ov.flag( o_rmnl );
+  bool flag_eval = ov.flag( o_eval );
+
+  const UTIL::proc_limits pl = limits_option( ov, o_timeout, o_cpu, o_mem );
 
   //
   // general argument validation:
@@ -203,23 +198,25 @@ ODIF::ODIF_Scanner::bif_shell(void)
   // unquote and trim the command string
   string scmd = UTIL::unquote_trim( fx_argv.arg( 1 ) );
 
-  string result;
-  bool good=false;
+  const string error_loc = amu_error_loc();
 
   filter_debug( scmd );
-  UTIL::sys_command( scmd, result, good, flag_stde, flag_rmnl );
 
-  if ( good == false )
-  {
-    return( amu_error_msg( result) );
-  }
-  else
-  {
-    if (flag_eval)
-      result = levm.expand_text(result);
+  // variable expansion must use the current map: do not defer.
+  return
+  (
+    run_command( scmd, flag_stde, flag_rmnl,
+      [=] (string& result, bool good) -> string
+      {
+        if ( good == false )
+          return( amu_error_msg( result, error_loc ) );
 
-    return( result );
-  }
+        if (flag_eval)
+          result = levm.expand_text(result);
+
+        return( result );
+      }, !flag_eval, &pl )
+  );
 }
 
 /***************************************************************************//**
@@ -251,6 +248,15 @@ ODIF::ODIF_Scanner::bif_shell(void)
       rmnl     | r   | true    | remove line-feeds / carriage returns
       pstarget | pst | false   | target is from parent source file
 
+    Resource limits (zero means no limit). When not specified, the
+    limits set on the command line are used.
+
+     options   | sc  | default | description
+    :---------:|:---:|:-------:|:-----------------------------------------
+      timeout  | to  | 0       | wall-clock time limit in seconds
+      cpu      | cpu | 0       | processor time limit in seconds
+      mem      | mem | 0       | address space limit in MiB
+
     A makefile build script can generate targets from either a scope
     embedded script or the the parent source file. The flag \p pstarget
     is used to distinguish between these origins. Setting \p ++pstarget
@@ -267,30 +273,25 @@ ODIF::ODIF_Scanner::bif_shell(void)
 string
 ODIF::ODIF_Scanner::bif_make(void)
 {
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_set, o_append, o_prepend, o_extension, o_target_prefix,
+         o_stderr, o_rmnl, o_pstarget, o_timeout, o_cpu, o_mem };
+  static constexpr opt_decl od[] =
   {
-  "set",              "si",
-  "append",           "a",
-  "prepend",          "p",
-  "extension",        "e",
-  "target_prefix",    "tp",
-  "stderr",           "s",
-  "rmnl",             "r",
-  "pstarget",         "pst"
+  { "set",            "si",   opt_text,   ""              },
+  { "append",         "a",    opt_text,   ""              },
+  { "prepend",        "p",    opt_text,   ""              },
+  { "extension",      "e",    opt_text,   ""              },
+  { "target_prefix",  "tp",   opt_text,   ""              },
+  { "stderr",         "s",    opt_flag,   ""              },
+  { "rmnl",           "r",    opt_flag,   ""              },
+  { "pstarget",       "pst",  opt_flag,   ""              },
+  { "timeout",        "to",   opt_int,    ""              },
+  { "cpu",            "cpu",  opt_int,    ""              },
+  { "mem",            "mem",  opt_int,    ""              }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  size_t ap=16;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
 
   //
   // assemble scope identifiers
@@ -307,6 +308,9 @@ ODIF::ODIF_Scanner::bif_make(void)
   bool flag_rmnl = true;
   bool flag_pstarget = false;
 
+  // command limits default
+  UTIL::proc_limits pl = get_proc_limits();
+
   // iterate over the arguments, skipping function name (position zero)
   for ( vector<func_args::arg_term>::iterator it=fx_argv.argv.begin()+1;
                                               it!=fx_argv.argv.end();
@@ -314,6 +318,7 @@ ODIF::ODIF_Scanner::bif_make(void)
   {
     string n = it->name;
     string v = it->value;
+    const size_t oi = os.find( n );
 
     if ( it->positional )
     { // append
@@ -322,41 +327,53 @@ ODIF::ODIF_Scanner::bif_make(void)
     }
     else
     {
-      if      (!(n.compare(vana[0])&&n.compare(vana[1])))
+      if      (oi == o_set)
       { // set
         makefile_stem = v;
         make_target = v;
       }
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
+      else if (oi == o_append)
       { // append
         makefile_stem = makefile_stem + get_scopejoiner() + v;
         make_target = make_target + mf_scopejoiner + v;
       }
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])))
+      else if (oi == o_prepend)
       { // prepend
         makefile_stem = v + get_scopejoiner() + makefile_stem;
         make_target = v + mf_scopejoiner + make_target;
       }
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])))
+      else if (oi == o_extension)
       { // extension
         target_ext = v;
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])))
+      else if (oi == o_target_prefix)
       { // target_prefix
         target_prefix = v;
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])))
+      else if (oi == o_stderr)
       { // stderr
         flag_stde=( atoi( v.c_str() ) > 0 );
       }
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])))
+      else if (oi == o_rmnl)
       { // rmnl
         flag_rmnl=( atoi( v.c_str() ) > 0 );
       }
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])))
+      else if (oi == o_pstarget)
       { // pstarget
         flag_pstarget=( atoi( v.c_str() ) > 0 );
       }
+      else if (oi == o_timeout)
+      { // timeout
+        pl.timeout = std::max( atoi( v.c_str() ), 0 );
+      }
+      else if (oi == o_cpu)
+      { // cpu
+        pl.cpu = std::max( atoi( v.c_str() ), 0 );
+      }
+      else if (oi == o_mem)
+      { // mem
+        pl.mem = std::max( atoi( v.c_str() ), 0 );
+      }
       else
       { // invalid
         return( amu_error_msg(n + "=" + v + " invalid option. " + help) );
@@ -378,31 +395,39 @@ ODIF::ODIF_Scanner::bif_make(void)
   string scmd;
   string opts = " --no-print-directory";
 
+  bfs::path makefile_path;
+
   // identify path prefix to makefile
   if ( get_prefix_scripts() )
+  {
     opts += " --directory=" + get_output_prefix();
+    makefile_path /= get_output_prefix();
+  }
   else if ( get_config_prefix().compare(".") && get_config_prefix().length() )
+  {
     opts += " --directory=" + get_config_prefix();
+    makefile_path /= get_config_prefix();
+  }
+
+  makefile_path /= makefile_stem + get_makefile_ext();
+  add_depend( makefile_path.string() );
 
   scmd = get_make_path() + opts
        + " --makefile=" + makefile_stem + get_makefile_ext()
        + " " + target_prefix + mf_scopejoiner + make_target;
 
   // issue system command
-  string result;
-  bool good=false;
+  const string error_loc = amu_error_loc();
 
   filter_debug( scmd );
-  UTIL::sys_command( scmd, result, good, flag_stde, flag_rmnl );
 
-  if ( good )
-  {
-    return( result );
-  }
-  else
-  {
-    return( amu_error_msg( result ) );
-  }
+  return
+  (
+    run_command( scmd, flag_stde, flag_rmnl,
+      [=] (string& result, bool good) -> string
+      { return( good ? result : amu_error_msg( result, error_loc ) ); },
+      true, &pl )
+  );
 }
 
 /***************************************************************************//**
@@ -449,37 +474,35 @@ ODIF::ODIF_Scanner::bif_scope(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_make, o_sort, o_unique, o_verbose,
+         o_index, o_count, o_list, o_join, o_root };
+  static constexpr opt_decl od[] =
   {
-  "make",     "m",
-  "sort",     "s",
-  "unique",   "u",
-  "verbose",  "v",
-
-  "index",    "i",
-  "count",    "c",
-  "list",     "l",
-  "join",     "j",
-  "root",     "r"
+  { "make",     "m",    opt_flag,   "1" },
+  { "sort",     "s",    opt_flag,   "0" },
+  { "unique",   "u",    opt_flag,   "1" },
+  { "verbose",  "v",    opt_flag,   "0" },
+
+  { "index",    "i",    opt_int,    ""  },
+  { "count",    "c",    opt_flag,   ""  },
+  { "list",     "l",    opt_flag,   ""  },
+  { "join",     "j",    opt_flag,   ""  },
+  { "root",     "r",    opt_flag,   ""  }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=18;
-  bool make     = ( atoi( unquote_trim(fx_argv.arg_firstof("1",vana[0],vana[1])).c_str() ) > 0 );
-  bool sort     = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[2],vana[3])).c_str() ) > 0 );
-  bool unique   = ( atoi( unquote_trim(fx_argv.arg_firstof("1",vana[4],vana[5])).c_str() ) > 0 );
-  bool verbose  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[6],vana[7])).c_str() ) > 0 );
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // assign control flags; output options are processed in order below.
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + "=" + bad->value + " invalid option. " + help) );
+
+  bool make     = ov.flag( o_make );
+  bool sort     = ov.flag( o_sort );
+  bool unique   = ov.flag( o_unique );
+  bool verbose  = ov.flag( o_verbose );
 
   string result;
   std::vector<std::string> sid_copy;
@@ -530,6 +553,7 @@ ODIF::ODIF_Scanner::bif_scope(void)
   {
     string n = it->name;
     string v = it->value;
+    const size_t oi = os.find( n );
     bool flag = ( atoi( v.c_str() ) > 0 );   // assign flag value
 
     if ( it->positional )
@@ -539,15 +563,15 @@ ODIF::ODIF_Scanner::bif_scope(void)
     else
     {
       if      (
-                !(n.compare(vana[0])&&n.compare(vana[1])) ||  // make
-                !(n.compare(vana[2])&&n.compare(vana[3])) ||  // sort
-                !(n.compare(vana[4])&&n.compare(vana[5])) ||  // unique
-                !(n.compare(vana[6])&&n.compare(vana[7]))     // verbose
+                oi == o_make ||
+                oi == o_sort ||
+                oi == o_unique ||
+                oi == o_verbose
               )
       {
         // do nothing, control flags values set above.
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])) && flag)
+      else if (oi == o_index && flag)
       { // index
         size_t index = atoi( v.c_str() );
 
@@ -574,14 +598,14 @@ ODIF::ODIF_Scanner::bif_scope(void)
           result.append( sid_copy[ index - 1 ] );
         }
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])) && flag)
+      else if (oi == o_count && flag)
       { // count
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( "count = " );
 
         result.append( to_string( sid_copy.size() ) );
       }
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])) && flag)
+      else if (oi == o_list && flag)
       { // list
         if ( verbose )
         {
@@ -597,14 +621,14 @@ ODIF::ODIF_Scanner::bif_scope(void)
           result.append( *vit );
         }
       }
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])) && flag)
+      else if (oi == o_join && flag)
       { // join
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( "join = " );
 
         result.append( get_scopejoiner() );
       }
-      else if (!(n.compare(vana[16])&&n.compare(vana[17])) && flag)
+      else if (oi == o_root && flag)
       { // root
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( "root = " );
@@ -656,35 +680,33 @@ ODIF::ODIF_Scanner::bif_source(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_current, o_absolute, o_verbose,
+         o_file, o_path, o_base, o_stem, o_ext };
+  static constexpr opt_decl od[] =
   {
-  "current",  "c",
-  "absolute", "a",
-  "verbose",  "v",
-
-  "file",     "f",
-  "path",     "p",
-  "base",     "b",
-  "stem",     "s",
-  "ext",      "e"
+  { "current",  "c",    opt_flag,   "0" },
+  { "absolute", "a",    opt_flag,   "0" },
+  { "verbose",  "v",    opt_flag,   "0" },
+
+  { "file",     "f",    opt_flag,   ""  },
+  { "path",     "p",    opt_flag,   ""  },
+  { "base",     "b",    opt_flag,   ""  },
+  { "stem",     "s",    opt_flag,   ""  },
+  { "ext",      "e",    opt_flag,   ""  }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=16;
-  bool current  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[0],vana[1])).c_str() ) > 0 );
-  bool absolute = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[2],vana[3])).c_str() ) > 0 );
-  bool verbose  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[4],vana[5])).c_str() ) > 0 );
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // assign control flags; output flags are processed in order below.
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + "=" + bad->value + " invalid option. " + help) );
+
+  bool current  = ov.flag( o_current );
+  bool absolute = ov.flag( o_absolute );
+  bool verbose  = ov.flag( o_verbose );
 
   string result;
 
@@ -712,6 +734,7 @@ ODIF::ODIF_Scanner::bif_source(void)
   {
     string n = it->name;
     string v = it->value;
+    const size_t oi = os.find( n );
     bool flag = ( atoi( v.c_str() ) > 0 );   // assign flag value
 
     if ( it->positional )
@@ -721,42 +744,42 @@ ODIF::ODIF_Scanner::bif_source(void)
     else
     {
       if      (
-                !(n.compare(vana[0])&&n.compare(vana[1])) ||  // current
-                !(n.compare(vana[2])&&n.compare(vana[3])) ||  // absolute
-                !(n.compare(vana[4])&&n.compare(vana[5]))     // verbose
+                oi == o_current ||
+                oi == o_absolute ||
+                oi == o_verbose
               )
       {
         // do nothing, control flags values set above.
       }
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])) && flag)
+      else if (oi == o_file && flag)
       { // file
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( path_type + " filename = " );
 
         result.append( input_path.string() );
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])) && flag)
+      else if (oi == o_path && flag)
       { // path
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( path_type + " pathname = " );
 
         result.append( input_path.parent_path().string() );
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])) && flag)
+      else if (oi == o_base && flag)
       { // base
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( "basename = " );
 
         result.append( input_path.filename().string() );
       }
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])) && flag)
+      else if (oi == o_stem && flag)
       { // stem
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( "stemname = " );
 
         result.append( input_path.stem().string() );
       }
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])) && flag)
+      else if (oi == o_ext && flag)
       { // ext
         if ( result.size() ) result.append( " " );
         if ( verbose ) result.append( "extension = " );
@@ -31,7 +31,6 @@
 *******************************************************************************/
 
 #include "openscad_dif_scanner.hpp"
-#include <set>
 
 // #include <boost/filesystem.hpp>
 #include <boost/tokenizer.hpp>
@@ -71,56 +70,25 @@ namespace bfs = boost::filesystem;
 string
 ODIF::ODIF_Scanner::bif_copy(void)
 {
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_files, o_types };
+  static constexpr opt_decl od[] =
   {
-  "files",            "f",
-  "types",            "t"
+  { "files",    "f",    opt_trim,   "" },
+  { "types",    "t",    opt_trim,   "" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
+  static const opt_schema os( od, "options",
+                              opt_schema::last | opt_schema::named );
+  const string& help = os.help();
 
-  // variables
-  size_t ap=0;
-  string files;  ap+=2;
-  string types;  ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  // parse named arguments (positional arguments are invalid).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + "=" + bad->value + " invalid option. " + help) );
 
-  // iterate over the arguments, skipping function name (position zero)
-  for ( vector<func_args::arg_term>::iterator it=fx_argv.argv.begin()+1;
-                                              it!=fx_argv.argv.end();
-                                              ++it )
-  {
-    string n = it->name;
-    string v = it->value;
-
-    if ( it->positional )
-    { // invalid
-      return( amu_error_msg(n + "=" + v + " invalid option. " + help) );
-    }
-    else
-    {
-      if      (!(n.compare(vana[0])&&n.compare(vana[1])))
-      { // files
-        files = UTIL::unquote_trim( v );
-      }
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
-      { // types
-        types = UTIL::unquote_trim( v );
-      }
-      else
-      { // invalid
-        return( amu_error_msg(n + "=" + v + " invalid option. " + help) );
-      }
-    }
-  }
+  string files = ov.str( o_files );
+  string types = ov.str( o_types );
 
   //
   // validate arguments
@@ -235,70 +203,32 @@ ODIF::ODIF_Scanner::bif_copy(void)
 string
 ODIF::ODIF_Scanner::bif_find(void)
 {
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_files, o_nfl, o_rmnl, o_skip };
+  static constexpr opt_decl od[] =
   {
-  "files",    "f",
-  "nfl",      "n",
-  "rmnl",     "r",
-  "skip",     "s"
+  { "files",    "f",    opt_trim,   ""  },
+  { "nfl",      "n",    opt_int,    "1" },
+  { "rmnl",     "r",    opt_flag,   "1" },
+  { "skip",     "s",    opt_flag,   "0" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
+  static const opt_schema os( od, "options",
+                              opt_schema::last | opt_schema::named );
+  const string& help = os.help();
+
+  // parse named arguments (positional arguments are invalid).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + "=" + bad->value + " invalid option. " + help) );
 
   // variables
-  size_t ap=0;
-  string files;           ap+=2;
-  int nfl = 1;            ap+=2;
+  string files = ov.str( o_files );
+  int nfl = ov.num( o_nfl );
 
   // flags
-  bool flag_rmnl = true;  ap+=2;
-  bool flag_skip = false; ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
-
-  // iterate over the arguments, skipping function name (position zero)
-  for ( vector<func_args::arg_term>::iterator it=fx_argv.argv.begin()+1;
-                                              it!=fx_argv.argv.end();
-                                              ++it )
-  {
-    string n = it->name;
-    string v = it->value;
-
-    if ( it->positional )
-    { // invalid
-      return( amu_error_msg(n + "=" + v + " invalid option. " + help) );
-    }
-    else
-    {
-      if      (!(n.compare(vana[0])&&n.compare(vana[1])))
-      { // files
-        files = UTIL::unquote_trim( v );
-      }
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
-      { // nfl (file not found limit)
-        nfl = atoi( v.c_str() );
-      }
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])))
-      { // rmnl
-        flag_rmnl=( atoi( v.c_str() ) > 0 );
-      }
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])))
-      { // skip
-        flag_skip=( atoi( v.c_str() ) > 0 );
-      }
-      else
-      { // invalid
-        return( amu_error_msg(n + "=" + v + " invalid option. " + help) );
-      }
-    }
-  }
+  bool flag_rmnl = ov.flag( o_rmnl );
+  bool flag_skip = ov.flag( o_skip );
 
   // remove line-feeds / carriage returns
   if ( flag_rmnl )
@@ -393,35 +323,27 @@ ODIF::ODIF_Scanner::bif_pathid(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_head, o_tail,
+         o_full, o_path, o_full_parent, o_path_parent,
+         o_root, o_stem, o_dir, o_parent };
+  static constexpr opt_decl od[] =
   {
-  "head",         "h",
-  "tail",         "t",
-
-  "full",         "f",
-  "path",         "a",
-  "full_parent",  "fp",
-  "path_parent",  "ap",
-
-  "root",         "r",
-  "stem",         "s",
-  "dir",          "d",
-  "parent",       "p"
+  { "head",         "h",    opt_int,    ""  },
+  { "tail",         "t",    opt_int,    ""  },
+
+  { "full",         "f",    opt_flag,   ""  },
+  { "path",         "a",    opt_flag,   ""  },
+  { "full_parent",  "fp",   opt_flag,   ""  },
+  { "path_parent",  "ap",   opt_flag,   ""  },
+
+  { "root",         "r",    opt_flag,   ""  },
+  { "stem",         "s",    opt_flag,   ""  },
+  { "dir",          "d",    opt_flag,   ""  },
+  { "parent",       "p",    opt_flag,   ""  }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=20;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
 
   string result;
 
@@ -457,6 +379,7 @@ ODIF::ODIF_Scanner::bif_pathid(void)
   {
     string n = it->name;
     string v = it->value;
+    const size_t oi = os.find( n );
 
     bool flag = ( atoi( v.c_str() ) > 0 );    // assign flag value
     bool limited = false;
@@ -479,13 +402,13 @@ ODIF::ODIF_Scanner::bif_pathid(void)
       // [ option with integer argument ]
       //
 
-      if      (!(n.compare(vana[0])&&n.compare(vana[1])))
+      if      (oi == o_head)
       { // head
         if ( result.size() ) result.append( path_joiner );
         if ( limited ) result.append( "limited" + path_joiner );
         result.append( input_path_vec[ index ] );
       }
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
+      else if (oi == o_tail)
       { // tail
         if ( result.size() ) result.append( path_joiner );
         result.append( input_path_vec[ input_path_vec.size() - 1 - index ] );
@@ -496,7 +419,7 @@ ODIF::ODIF_Scanner::bif_pathid(void)
       // [ flags ]
       //
 
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])) && flag)
+      else if (oi == o_full && flag)
       { // full
         for( vector<string>::iterator vit=input_path_vec.begin();
                                       vit!=input_path_vec.end();
@@ -506,7 +429,7 @@ ODIF::ODIF_Scanner::bif_pathid(void)
           result.append( *vit );
         }
       }
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])) && flag)
+      else if (oi == o_path && flag)
       { // path
         if ( input_path_vec.size() > 1 )
         {
@@ -519,7 +442,7 @@ ODIF::ODIF_Scanner::bif_pathid(void)
           }
         }
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])) && flag)
+      else if (oi == o_full_parent && flag)
       { // full_parent
         if ( input_path_vec.size() > 1 )
         {
@@ -536,7 +459,7 @@ ODIF::ODIF_Scanner::bif_pathid(void)
           result.append( "none" );
         }
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])) && flag)
+      else if (oi == o_path_parent && flag)
       { // path_parent
         if ( input_path_vec.size() > 2 )
         {
@@ -554,22 +477,22 @@ ODIF::ODIF_Scanner::bif_pathid(void)
       // [ flags ]
       //
 
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])) && flag)
+      else if (oi == o_root && flag)
       { // root
         if ( result.size() ) result.append( path_joiner );
         result.append( input_path_vec[ 0 ] );
       }
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])) && flag)
+      else if (oi == o_stem && flag)
       { // stem
         if ( result.size() ) result.append( path_joiner );
         result.append( input_path.stem().string() );
       }
-      else if (!(n.compare(vana[16])&&n.compare(vana[17])) && flag)
+      else if (oi == o_dir && flag)
       { // dir
         if ( result.size() ) result.append( path_joiner );
         result.append( input_path_vec[ input_path_vec.size() - 1 ] );
       }
-      else if (!(n.compare(vana[18])&&n.compare(vana[19])) && flag)
+      else if (oi == o_parent && flag)
       { // parent or 'none'
         if ( result.size() ) result.append( path_joiner );
         if ( input_path_vec.size() > 1 )
@@ -622,31 +545,24 @@ ODIF::ODIF_Scanner::bif_filename(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_files, o_tokenizer, o_separator,
+         o_file, o_path, o_base, o_stem, o_ext };
+  static constexpr opt_decl od[] =
   {
-  "files",      "f",
+  { "files",      "f",    opt_text,   ""    },
 
-  "tokenizer",  "t",
-  "separator",  "r",
+  { "tokenizer",  "t",    opt_text,   ""    },
+  { "separator",  "r",    opt_text,   ""    },
 
-  "file",       "n",
-  "path",       "p",
-  "base",       "b",
-  "stem",       "s",
-  "ext",        "e"
+  { "file",       "n",    opt_flag,   ""    },
+  { "path",       "p",    opt_flag,   ""    },
+  { "base",       "b",    opt_flag,   ""    },
+  { "stem",       "s",    opt_flag,   ""    },
+  { "ext",        "e",    opt_flag,   ""    }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // generate options help string.
-  size_t ap=16;
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
 
   //
   // assemble result
@@ -665,6 +581,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
   {
     string n = it->name;
     string v = it->value;
+    const size_t oi = os.find( n );
     bool flag = ( atoi( v.c_str() ) > 0 );   // assign flag value
 
     if ( it->positional )
@@ -673,7 +590,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
     }
     else
     {
-      if (!(n.compare(vana[0])&&n.compare(vana[1])))
+      if (oi == o_files)
       { // file list
         string fl_s = unquote( v );
 
@@ -686,11 +603,11 @@ ODIF::ODIF_Scanner::bif_filename(void)
           fl_v.push_back( boost::trim_copy( *fit ) );
       }
 
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
+      else if (oi == o_tokenizer)
       { // tokenizer
         tokl = unquote( v );
       }
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])))
+      else if (oi == o_separator)
       { // separator
         fsep = unquote( v );
       }
@@ -698,7 +615,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
       //
       // flags
       //
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])) && flag)
+      else if (oi == o_file && flag)
       { // file
         for ( vector<string>::const_iterator fit=fl_v.begin(); fit!=fl_v.end(); ++fit )
         {
@@ -706,7 +623,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
             result.append( bfs::path( *fit ).string() );
         }
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])) && flag)
+      else if (oi == o_path && flag)
       { // path
         for ( vector<string>::const_iterator fit=fl_v.begin(); fit!=fl_v.end(); ++fit )
         {
@@ -714,7 +631,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
             result.append( bfs::path( *fit ).parent_path().string() );
         }
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])) && flag)
+      else if (oi == o_base && flag)
       { // base
         for ( vector<string>::const_iterator fit=fl_v.begin(); fit!=fl_v.end(); ++fit )
         {
@@ -722,7 +639,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
           result.append( bfs::path( *fit ).filename().string() );
         }
       }
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])) && flag)
+      else if (oi == o_stem && flag)
       { // stem
         for ( vector<string>::const_iterator fit=fl_v.begin(); fit!=fl_v.end(); ++fit )
         {
@@ -730,7 +647,7 @@ ODIF::ODIF_Scanner::bif_filename(void)
           result.append( bfs::path( *fit ).stem().string() );
         }
       }
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])) && flag)
+      else if (oi == o_ext && flag)
       { // ext
         for ( vector<string>::const_iterator fit=fl_v.begin(); fit!=fl_v.end(); ++fit )
         {
@@ -754,6 +671,11 @@ ODIF::ODIF_Scanner::bif_filename(void)
 
     Text file read operations.
 
+    Source files are mapped into memory once per run and their line
+    offsets indexed, so that repeated reads and line range selections
+    of the same file do not re-read it. A file is reloaded when its
+    size or modification time changes.
+
     The options and flags (and their short codes) are summarized in the
     following tables.
 
@@ -796,65 +718,59 @@ ODIF::ODIF_Scanner::bif_file(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_file, o_text, o_first, o_last, o_separator,
+         o_rmecho, o_rmnl, o_eval, o_quiet,
+         o_read, o_lines, o_chars, o_max, o_min };
+  static constexpr opt_decl od[] =
   {
-  "file",       "f",
-  "text",       "t",
+  { "file",       "f",    opt_trim,   ""  },
+  { "text",       "t",    opt_text,   ""  },
 
-  "first",      "i",
-  "last",       "l",
+  { "first",      "i",    opt_int,    "1" },
+  { "last",       "l",    opt_int,    "0" },
 
-  "separator",  "s",
+  { "separator",  "s",    opt_text,   ""  },
 
-  "rmecho",     "o",
-  "rmnl",       "r",
-  "eval",       "e",
-  "quiet",      "q",
+  { "rmecho",     "o",    opt_flag,   "0" },
+  { "rmnl",       "r",    opt_flag,   "0" },
+  { "eval",       "e",    opt_flag,   "0" },
+  { "quiet",      "q",    opt_flag,   "0" },
 
-  "read",       "rd",
-  "lines",      "lc",
-  "chars",      "cc",
-  "max",        "xl",
-  "min",        "nl"
+  { "read",       "rd",   opt_flag,   "0" },
+  { "lines",      "lc",   opt_flag,   "0" },
+  { "chars",      "cc",   opt_flag,   "0" },
+  { "max",        "xl",   opt_flag,   "0" },
+  { "min",        "nl",   opt_flag,   "0" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=0;
-  string file = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string text = unquote     (fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-
-  uint first  = atoi( unquote_trim(fx_argv.arg_firstof("1",vana[ap],vana[ap+1])).c_str() ); ap+=2;
-  uint last   = atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ); ap+=2;
-
-  string wsep = unquote     (fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-
-  bool rmecho = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool rmnl   = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool eval   = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool quiet  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  bool read   = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool lines  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool chars  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool maxln  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool minln  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
+
+  // assign local variable values.
+  string file = ov.str( o_file );
+  string text = ov.str( o_text );
+
+  uint first  = ov.num( o_first );
+  uint last   = ov.num( o_last );
+
+  string wsep = ov.str( o_separator );
 
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  bool rmecho = ov.flag( o_rmecho );
+  bool rmnl   = ov.flag( o_rmnl );
+  bool eval   = ov.flag( o_eval );
+  bool quiet  = ov.flag( o_quiet );
+
+  bool read   = ov.flag( o_read );
+  bool lines  = ov.flag( o_lines );
+  bool chars  = ov.flag( o_chars );
+  bool maxln  = ov.flag( o_max );
+  bool minln  = ov.flag( o_min );
 
   //
   // general argument validation:
@@ -870,64 +786,96 @@ ODIF::ODIF_Scanner::bif_file(void)
 
   string result;
 
-  bool ids_ready = false;
-
-  ifstream      ifs;          // file stream
-  istringstream iss;          // string stream
+  const line_index* ids = NULL;   // indexed input lines
+  line_index        tli;          // text source index
 
   if ( !file.empty() )
-  { // use file stream
+  { // use mapped file
     bool found = false;
     string rl = file_rl( file, NO_FORMAT_OUTPUT, found );
 
     if ( found  )
     {
-      ifs.open( rl.c_str() );
-      ids_ready = ifs.is_open();
+      ids = file_lines.get( rl );
 
-      if ( !ids_ready && !quiet )
+      if ( ids == NULL && !quiet )
         result.append( amu_error_msg("unable to open: " + file) );
     }
     else if ( !quiet )
       result.append( amu_error_msg("unable to find: " + file) );
   }
   else if ( !text.empty() )
-  { // use text stream
-    iss.str( text );
-    ids_ready = true;
+  { // use text
+    tli.assign( text.data(), text.size() );
+    ids = &tli;
   }
   else
   { // error: no source
     if ( !quiet )
       result.append( amu_error_msg("no source file or text.") );
-
-    ids_ready = false;
   }
 
-  // assign input data stream source
-  istream& ids = ifs.is_open() ? static_cast<istream&>(ifs)
-                               : static_cast<istream&>(iss);
-
-  if ( ids_ready  )
+  if ( ids != NULL )
   {
-    uint ids_line   = 0;          // current line of input
+    // selected line range [ids_first, ids_end), zero based.
+    size_t ids_first = ( first > 0 ) ? first - 1 : 0;
+    size_t ids_end   = ids->lines();
+
+    if ( last != 0 && last < ids_end )
+      ids_end = last;
+    if ( ids_first > ids_end )
+      ids_first = ids_end;
 
-    uint text_line  = 0;          // current stats of processed input
+    const string eol = rmnl ? wsep : "\n";
+
+    uint text_line  = ids_end - ids_first;  // stats of processed input
     uint char_count = 0;
     uint line_max   = 0;
     uint line_min   = UINT_MAX;
 
-    string line;
     string data;
 
-    while ( !ids.eof() )
-    {
-      getline(ids, line);
-      ids_line++;
+    if ( !rmecho && !eval )
+    { // lines are used unchanged: take statistics from the index
+      size_t total = 0;
+
+      if ( ids_first == 0 && ids_end == ids->lines() )
+      {
+        total = ids->total_length();
+        line_max = ids->max_length();
+        if ( ids->min_length() != line_index::npos )
+          line_min = ids->min_length();
+      }
+      else
+      {
+        for ( size_t i=ids_first; i < ids_end; ++i )
+        {
+          size_t l = ids->length( i );
+
+          total += l;
+          if ( l > line_max ) line_max = l;
+          if ( l && l < line_min ) line_min = l;
+        }
+      }
 
-      if ( (ids_line >= first) && ( (last == 0) || (ids_line<=last) ) )
+      char_count = total + text_line * eol.size();
+
+      if ( read )
       {
-        text_line++;
+        data.reserve( char_count );
+
+        for ( size_t i=ids_first; i < ids_end; ++i )
+        {
+          data.append( ids->line( i ), ids->length( i ) );
+          data.append( eol );
+        }
+      }
+    }
+    else
+    {
+      for ( size_t i=ids_first; i < ids_end; ++i )
+      {
+        string line( ids->line( i ), ids->length( i ) );
 
         // remove echo
         if ( rmecho )
@@ -944,10 +892,7 @@ ODIF::ODIF_Scanner::bif_file(void)
           line_min = line.size();
 
         // handle end of line
-        if ( rmnl )
-          line += wsep;
-        else
-          line += "\n";
+        line += eol;
 
         char_count += line.size();
 
@@ -990,10 +935,6 @@ ODIF::ODIF_Scanner::bif_file(void)
     }
   }
 
-  // close file if open
-  if ( ifs.is_open() )
-    ifs.close();
-
   return ( result );
 }
 
@@ -31,12 +31,11 @@
 *******************************************************************************/
 
 #include "openscad_dif_scanner.hpp"
-#include <set>
 
-#include <boost/tokenizer.hpp>
-#include <boost/algorithm/string.hpp>
 #include <boost/xpressive/xpressive.hpp>
 
+#include <limits>
+
 #if defined(HAVE_CONFIG_H)
 #include "config.h"
 #endif
@@ -44,6 +43,45 @@
 using namespace std;
 
 
+namespace {
+  //! compiled regular expression cache (see bif_replace).
+  typedef ODIF::lru_cache< std::pair<std::string, int>,
+                           boost::xpressive::sregex > regex_cache_type;
+
+  regex_cache_type& regex_cache(void)
+  {
+    static regex_cache_type c( 128 );
+    return ( c );
+  }
+
+  //! return the compiled expression for pattern p with syntax flags f.
+  const boost::xpressive::sregex&
+  regex_compile(const std::string& p,
+                const boost::xpressive::regex_constants::syntax_option_type f)
+  {
+    std::pair<std::string, int> k( p, static_cast<int>(f) );
+
+    boost::xpressive::sregex* r = regex_cache().find( k );
+    if ( r != NULL )
+      return ( *r );
+
+    return ( regex_cache().insert( k, boost::xpressive::sregex::compile( p, f ) ) );
+  }
+}
+
+size_t
+ODIF::ODIF_Scanner::get_regex_hit_count(void)
+{
+  return ( regex_cache().get_hit_count() );
+}
+
+size_t
+ODIF::ODIF_Scanner::get_regex_miss_count(void)
+{
+  return ( regex_cache().get_miss_count() );
+}
+
+
 /***************************************************************************//**
 
   \details
@@ -70,6 +108,20 @@ using namespace std;
       joiner     | j   | [_]            | set member joiner
       separator  | f   | [,]            | word separator
       tokenizer  | t   | [\|,[:space:]] | set-members tokenizer characters
+      index      | i   | 1              | first word of the result
+      limit      | l   | 0              | maximum number of words (0=all)
+
+    Flags that produce output:
+
+     flags     | sc  | default | description
+    :---------:|:---:|:-------:|:-----------------------------------------
+      count    | c   | false   | return number of combined words
+
+    The words are enumerated in order with the members of the last set
+    changing fastest. With \p index and \p limit a slice of the
+    combinations is produced without generating those before it, and
+    \p count returns the total number of combinations without
+    generating any. A total that cannot be represented is an error.
 
     For more information on how to specify and use function arguments
     see \ref openscad_dif_sm_a.
@@ -80,94 +132,140 @@ ODIF::ODIF_Scanner::bif_combine(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_prefix, o_suffix, o_joiner, o_separator, o_tokenizer,
+         o_index, o_limit, o_count };
+  static constexpr opt_decl od[] =
   {
-  "prefix",     "p",
-  "suffix",     "s",
-  "joiner",     "j",
-  "separator",  "f",
-  "tokenizer",  "t"
+  { "prefix",     "p",  opt_text,  ""    },
+  { "suffix",     "s",  opt_text,  ""    },
+  { "joiner",     "j",  opt_text,  "_"   },
+  { "separator",  "f",  opt_text,  ","   },
+  { "tokenizer",  "t",  opt_text,  "|, " },
+  { "index",      "i",  opt_int,   "1"   },
+  { "limit",      "l",  opt_int,   "0"   },
+  { "count",      "c",  opt_flag,  "0"   }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
+  static const opt_schema os( od );
+  const string& help = os.help();
 
-  // assign local variable values: positions must match declaration above.
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
+
+  // assign local variable values.
   // do not trim to allow combining of natural language.
-  size_t ap=0;
-  string prefix     = unquote(fx_argv.arg_firstof(   "",vana[ap],vana[ap+1])); ap+=2;
-  string suffix     = unquote(fx_argv.arg_firstof(   "",vana[ap],vana[ap+1])); ap+=2;
-  string joiner     = unquote(fx_argv.arg_firstof(  "_",vana[ap],vana[ap+1])); ap+=2;
-  string separator  = unquote(fx_argv.arg_firstof(  ",",vana[ap],vana[ap+1])); ap+=2;
-  string tokenizer  = unquote(fx_argv.arg_firstof("|, ",vana[ap],vana[ap+1])); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  string prefix     = ov.str( o_prefix );
+  string suffix     = ov.str( o_suffix );
+  string joiner     = ov.str( o_joiner );
+  string separator  = ov.str( o_separator );
+  string tokenizer  = ov.str( o_tokenizer );
 
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  int index         = ov.num( o_index );
+  int limit         = ov.num( o_limit );
+  bool count        = ov.flag( o_count );
 
   //
   // general argument validation:
   //
 
-  // get the positional arguments as vector (except arg0).
-  vector<string> pa = fx_argv.values_v(false, true);
-  pa.erase( pa.begin() );
+  if ( index < 1 )
+    return( amu_error_msg("index must be greater than zero. " + help) );
 
-  // created the vector of sets to combine with grouping quotes removed.
-  // do not trim to allow combining of natural language.
-  vector<string> sv;
-  for ( vector<string>::iterator it=pa.begin(); it!=pa.end(); ++it )
-    sv.push_back( unquote( *it ) );
+  if ( limit < 0 )
+    return( amu_error_msg("limit must not be negative. " + help) );
 
-  string result;
-  bif_combineR( result, sv, prefix, suffix, joiner, separator, tokenizer);
+  // split each positional argument set once (except arg0), with
+  // grouping quotes removed, or use the list value of the argument.
+  // do not trim to allow combining of natural language.
+  vector<word_list> sv;
+  for ( vector<func_args::arg_term>::const_iterator it=fx_argv.argv.begin()+1;
+                                                    it!=fx_argv.argv.end();
+                                                    ++it )
+  {
+    if ( !it->positional )
+      continue;
 
-  return( result );
-}
+    sv.push_back( word_list() );
+    if ( !fx_arg_list( &it->value, tokenizer, false, sv.back() ) )
+      sv.back().assign( unquote( it->value ), tokenizer );
+  }
 
-void
-ODIF::ODIF_Scanner::bif_combineR( string &r, vector<string> sv,
-                                  const string &p, const string &s,
-                                  const string &j, const string &ws,
-                                  const string &t )
-{
-  // check recursion termination.
-  if ( sv.size()== 0 )
+  // number of combinations (zero when any set is empty), which must be
+  // representable as the result of count (see UTIL::to_string()).
+  const size_t nmax = static_cast<size_t>( numeric_limits<long>::max() );
+  size_t total = 1;
+  bool overflow = false;
+  for ( size_t i=0; i < sv.size(); ++i )
   {
-    // append word separator after the first word
-    if( r.length() !=0 ) r+= ws;
+    size_t n = sv[i].size();
+
+    if ( n == 0 )
+    {
+      total = 0;
+      overflow = false;
+      break;
+    }
 
-    r+=p + s;
+    if ( overflow || total > nmax / n ) overflow = true;
+    else                                total *= n;
   }
-  else
-  {
-    // separate member words of first set of 'sv' and store in 'sm'
-    string          fs = sv.front();
-    vector<string>  sm;
 
-    typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
+  if ( overflow )
+    return( amu_error_msg("number of combinations exceeds "
+                          + UTIL::to_string( nmax ) + ". " + help) );
+
+  if ( count )
+    return( UTIL::to_string( total ) );
+
+  //
+  // enumerate: mixed-radix counter over the sets, last set fastest.
+  //
+  shared_ptr<word_list> result = make_shared<word_list>();
 
-    boost::char_separator<char> sep( t.c_str() );
-    tokenizer tokens(fs, sep);
+  size_t first = static_cast<size_t>( index - 1 );
+  if ( first >= total )
+    return( string() );
 
-    for ( tokenizer::iterator it=tokens.begin(); it!=tokens.end(); ++it )
-      sm.push_back( j + *it );
+  size_t words = total - first;
+  if ( limit > 0 && static_cast<size_t>(limit) < words )
+    words = limit;
 
-    // for each word in 'sm' combine with words of remaining sets
-    sv.erase( sv.begin() );
-    for ( vector<string>::iterator it=sm.begin(); it!=sm.end(); ++it )
-      bif_combineR(r, sv, p + *it, s, j, ws, t);
+  // counter digits for the first word
+  vector<size_t> digit( sv.size(), 0 );
+  for ( size_t i=sv.size(), r=first; i-- > 0; )
+  {
+    digit[i] = r % sv[i].size();
+    r /= sv[i].size();
+  }
+
+  const string no_sep;
+  string word;
+  for ( size_t w=0; w < words; ++w )
+  {
+    word = prefix;
+    for ( size_t i=0; i < sv.size(); ++i )
+    {
+      word.append( joiner );
+      sv[i].append_to( digit[i], word );
+    }
+    word.append( suffix );
+
+    // append word separator after the first word
+    result->append( word, ( w != 0 ) ? separator : no_sep );
+
+    // advance counter
+    for ( size_t i=sv.size(); i-- > 0; )
+    {
+      if ( ++digit[i] < sv[i].size() ) break;
+      digit[i] = 0;
+    }
   }
+
+  fx_list = result;
+  return( result->release() );
 }
 
 /***************************************************************************//**
@@ -247,87 +345,85 @@ ODIF::ODIF_Scanner::bif_replace(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_text, o_search, o_replace, o_icase, o_nosubs, o_optimize,
+         o_collate, o_single_line, o_not_dot_null, o_not_dot_newline,
+         o_ignore_white_space, o_match_not_bol, o_match_not_eol,
+         o_match_not_bow, o_match_not_eow, o_match_any, o_match_not_null,
+         o_match_continuous, o_match_partial, o_match_prev_avail,
+         o_format_sed, o_format_perl, o_format_no_copy, o_format_first_only,
+         o_format_literal, o_format_all };
+  static constexpr opt_decl od[] =
   {
-  "text",               "t",
-  "search",             "s",
-  "replace",            "r",
-
-  "icase",              "sic",
-  "nosubs",             "sns",
-  "optimize",           "soe",
-  "collate",            "sce",
-  "single_line",        "ssl",
-  "not_dot_null",       "snn",
-  "not_dot_newline",    "snl",
-  "ignore_white_space", "sis",
-
-  "match_not_bol",      "mbl",
-  "match_not_eol",      "mel",
-  "match_not_bow",      "mbw",
-  "match_not_eow",      "mew",
-  "match_any",          "maa",
-  "match_not_null",     "mnn",
-  "match_continuous",   "mcf",
-  "match_partial",      "mpa",
-  "match_prev_avail",   "mpr",
-
-  "format_sed",         "fsd",
-  "format_perl",        "fpl",
-  "format_no_copy",     "fnc",
-  "format_first_only",  "ffo",
-  "format_literal",     "flf",
-  "format_all",         "fas"
+  { "text",                "t",    opt_text,  ""  },
+  { "search",              "s",    opt_text,  ""  },
+  { "replace",             "r",    opt_text,  ""  },
+
+  { "icase",               "sic",  opt_flag,  "0" },
+  { "nosubs",              "sns",  opt_flag,  "0" },
+  { "optimize",            "soe",  opt_flag,  "0" },
+  { "collate",             "sce",  opt_flag,  "0" },
+  { "single_line",         "ssl",  opt_flag,  "0" },
+  { "not_dot_null",        "snn",  opt_flag,  "0" },
+  { "not_dot_newline",     "snl",  opt_flag,  "0" },
+  { "ignore_white_space",  "sis",  opt_flag,  "0" },
+
+  { "match_not_bol",       "mbl",  opt_flag,  "0" },
+  { "match_not_eol",       "mel",  opt_flag,  "0" },
+  { "match_not_bow",       "mbw",  opt_flag,  "0" },
+  { "match_not_eow",       "mew",  opt_flag,  "0" },
+  { "match_any",           "maa",  opt_flag,  "0" },
+  { "match_not_null",      "mnn",  opt_flag,  "0" },
+  { "match_continuous",    "mcf",  opt_flag,  "0" },
+  { "match_partial",       "mpa",  opt_flag,  "0" },
+  { "match_prev_avail",    "mpr",  opt_flag,  "0" },
+
+  { "format_sed",          "fsd",  opt_flag,  "0" },
+  { "format_perl",         "fpl",  opt_flag,  "0" },
+  { "format_no_copy",      "fnc",  opt_flag,  "0" },
+  { "format_first_only",   "ffo",  opt_flag,  "0" },
+  { "format_literal",      "flf",  opt_flag,  "0" },
+  { "format_all",          "fas",  opt_flag,  "0" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=0;
-  string text     = unquote(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string search   = unquote(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string replace  = unquote(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-
-  bool sic = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool sns = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool soe = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool sce = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool ssl = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool snn = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool snl = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool sis = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  bool mbl = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mel = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mbw = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mew = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool maa = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mnn = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mcf = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mpa = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool mpr = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  bool fsd = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool fpl = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool fnc = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool ffo = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool flf = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool fas = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
-
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
+
+  // assign local variable values.
+  string text     = ov.str( o_text );
+  string search   = ov.str( o_search );
+  string replace  = ov.str( o_replace );
+
+  bool sic = ov.flag( o_icase );
+  bool sns = ov.flag( o_nosubs );
+  bool soe = ov.flag( o_optimize );
+  bool sce = ov.flag( o_collate );
+  bool ssl = ov.flag( o_single_line );
+  bool snn = ov.flag( o_not_dot_null );
+  bool snl = ov.flag( o_not_dot_newline );
+  bool sis = ov.flag( o_ignore_white_space );
+
+  bool mbl = ov.flag( o_match_not_bol );
+  bool mel = ov.flag( o_match_not_eol );
+  bool mbw = ov.flag( o_match_not_bow );
+  bool mew = ov.flag( o_match_not_eow );
+  bool maa = ov.flag( o_match_any );
+  bool mnn = ov.flag( o_match_not_null );
+  bool mcf = ov.flag( o_match_continuous );
+  bool mpa = ov.flag( o_match_partial );
+  bool mpr = ov.flag( o_match_prev_avail );
+
+  bool fsd = ov.flag( o_format_sed );
+  bool fpl = ov.flag( o_format_perl );
+  bool fnc = ov.flag( o_format_no_copy );
+  bool ffo = ov.flag( o_format_first_only );
+  bool flf = ov.flag( o_format_literal );
+  bool fas = ov.flag( o_format_all );
 
   //
   // general argument validation:
@@ -366,7 +462,8 @@ ODIF::ODIF_Scanner::bif_replace(void)
   if ( snl ) res_f = res_f | regex_constants::not_dot_newline;
   if ( sis ) res_f = res_f | regex_constants::ignore_white_space;
 
-  sregex sre = sregex::compile( search, res_f );
+  // compiled expressions by (pattern, syntax flags), kept for the run.
+  const sregex& sre = regex_compile( search, res_f );
 
   // regex algorithms behavior flag
   regex_constants::match_flag_type rab_f;
@@ -452,50 +549,55 @@ ODIF::ODIF_Scanner::bif_word(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_words, o_index, o_find, o_tokenizer, o_separator,
+         o_count, o_first, o_last, o_list };
+  static constexpr opt_decl od[] =
   {
-  "words",      "w",
-  "index",      "i",
-  "find",       "n",
+  { "words",      "w",    opt_text,   ""      },
+  { "index",      "i",    opt_int,    ""      },
+  { "find",       "n",    opt_text,   ""      },
 
-  "tokenizer",  "t",
-  "separator",  "r",
+  { "tokenizer",  "t",    opt_text,   ""      },
+  { "separator",  "r",    opt_text,   ""      },
 
-  "count",      "c",
-  "first",      "f",
-  "last",       "l",
-  "list",       "s"
+  { "count",      "c",    opt_flag,   ""      },
+  { "first",      "f",    opt_flag,   ""      },
+  { "last",       "l",    opt_flag,   ""      },
+  { "list",       "s",    opt_flag,   ""      }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // generate options help string.
-  size_t ap=16;
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
 
   //
   // assemble result
   //
-  string result;
+  shared_ptr<word_list> result = make_shared<word_list>();
+  const string no_sep;
 
   string tokl = "~^, "; // assign default token list
   string wsep = "^";    // assign default output file separator
 
-  vector<string> wl_v;
+  // append word w to result, after the separator when not first.
+  auto add_word = [&] (const string& w)
+    { result->append( w, result->str().empty() ? no_sep : wsep ); };
+
+  // word lists are split once per distinct list text and tokenizer, so
+  // that selecting from the same list in successive calls is a lookup.
+  // the list value of a variable is used without splitting, and the
+  // words split from a variable are kept as its list value.
+  static const word_list no_words;
+  const word_list* wl_v = &no_words;
+  word_list wl_arg;
 
   // iterate over the arguments, skipping function name (position zero)
   for ( vector<func_args::arg_term>::iterator it=fx_argv.argv.begin()+1;
                                               it!=fx_argv.argv.end();
                                               ++it )
   {
-    string n = it->name;
-    string v = it->value;
+    const string& n = it->name;
+    const string& v = it->value;
+    const size_t oi = os.find( n );
     bool flag = ( atoi( v.c_str() ) > 0 );   // assign flag value
 
     if ( it->positional )
@@ -504,52 +606,48 @@ ODIF::ODIF_Scanner::bif_word(void)
     }
     else
     {
-      if (!(n.compare(vana[0])&&n.compare(vana[1])))
+      if (oi == o_words)
       { // word list
-        string wl_s = unquote( v );
+        if ( fx_arg_list( &v, tokl, true, wl_arg ) )
+          wl_v = &wl_arg;
+        else
+        {
+          size_t b, l;
+          unquote_bounds( v, b, l );
 
-        typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
-        boost::char_separator<char> wsep( tokl.c_str() );
-        tokenizer wl_tok( wl_s, wsep );
+          wl_v = &word_lists.get( v.data() + b, l, tokl, true );
 
-        wl_v.clear();
-        for ( tokenizer::iterator wit=wl_tok.begin(); wit!=wl_tok.end(); ++wit )
-          wl_v.push_back( boost::trim_copy( *wit ) );
+          fx_keep_arg_list( it - fx_argv.argv.begin(), b, *wl_v );
+        }
       }
 
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
+      else if (oi == o_index)
       { // index
         size_t i = atoi( v.c_str() );
 
-        if ( (i>0) && (i<wl_v.size()) )
-        {
-          if ( result.size() ) result.append( wsep );
-            result.append( wl_v[ i - 1 ] );
-        }
+        if ( (i>0) && (i<wl_v->size()) )
+          add_word( (*wl_v)[ i - 1 ] );
       }
 
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])))
+      else if (oi == o_find)
       { // find
         string key = unquote( v );
         size_t pos = 0;
 
-        for ( vector<string>::const_iterator wit=wl_v.begin(); wit!=wl_v.end(); ++wit )
+        for ( size_t wi=0; wi < wl_v->size(); ++wi )
         {
           pos++;
 
-          if ( *wit == key )
-          {
-            if ( result.size() ) result.append( wsep );
-            result.append( UTIL::to_string( pos ) );
-          }
+          if ( wl_v->equals( wi, key ) )
+            add_word( UTIL::to_string( pos ) );
         }
       }
 
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])))
+      else if (oi == o_tokenizer)
       { // tokenizer
         tokl = unquote( v );
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])))
+      else if (oi == o_separator)
       { // separator
         wsep = unquote( v );
       }
@@ -557,34 +655,24 @@ ODIF::ODIF_Scanner::bif_word(void)
       //
       // flags
       //
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])) && flag)
+      else if (oi == o_count && flag)
       { // count
-        if ( result.size() ) result.append( wsep );
-          result.append( UTIL::to_string(wl_v.size()) );
+        add_word( UTIL::to_string(wl_v->size()) );
       }
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])) && flag)
+      else if (oi == o_first && flag)
       { // first
-        if ( ! wl_v.empty() )
-        {
-          if ( result.size() ) result.append( wsep );
-            result.append( wl_v[ 0 ] );
-        }
+        if ( ! wl_v->empty() )
+          add_word( (*wl_v)[ 0 ] );
       }
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])) && flag)
+      else if (oi == o_last && flag)
       { // last
-        if ( ! wl_v.empty() )
-        {
-          if ( result.size() ) result.append( wsep );
-            result.append( wl_v[ wl_v.size() -1 ] );
-        }
+        if ( ! wl_v->empty() )
+          add_word( (*wl_v)[ wl_v->size() -1 ] );
       }
-      else if (!(n.compare(vana[16])&&n.compare(vana[17])) && flag)
+      else if (oi == o_list && flag)
       { // list
-        for ( vector<string>::const_iterator wit=wl_v.begin(); wit!=wl_v.end(); ++wit )
-        {
-          if ( result.size() ) result.append( wsep );
-          result.append( *wit );
-        }
+        for ( size_t wi=0; wi < wl_v->size(); ++wi )
+          add_word( (*wl_v)[ wi ] );
       }
 
       else
@@ -594,7 +682,8 @@ ODIF::ODIF_Scanner::bif_word(void)
     }
   }
 
-  return ( result );
+  fx_list = result;
+  return ( result->release() );
 }
 
 /***************************************************************************//**
@@ -634,36 +723,31 @@ ODIF::ODIF_Scanner::bif_seq(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_first, o_incr, o_last, o_prefix, o_suffix, o_separator,
+         o_format, o_number, o_roman };
+  static constexpr opt_decl od[] =
   {
-  "first",      "f",
-  "incr",       "i",
-  "last",       "l",
-  "prefix",     "p",
-  "suffix",     "s",
-  "separator",  "r",
-  "format",     "o",
-
-  "number",     "n",
-  "roman",      "m"
+  { "first",      "f",    opt_int,    ""  },
+  { "incr",       "i",    opt_int,    ""  },
+  { "last",       "l",    opt_int,    ""  },
+  { "prefix",     "p",    opt_text,   ""  },
+  { "suffix",     "s",    opt_text,   ""  },
+  { "separator",  "r",    opt_text,   ""  },
+  { "format",     "o",    opt_text,   ""  },
+
+  { "number",     "n",    opt_flag,   ""  },
+  { "roman",      "m",    opt_flag,   ""  }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // generate options help string.
-  size_t ap=18;
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  static const opt_schema os( od );
+  const string& help = os.help();
 
   //
   // assemble result
   //
-  string result;
+  shared_ptr<word_list> result = make_shared<word_list>();
+  const string no_sep;
+  string word;
 
   int first = 1;
   int incr  = 1;
@@ -683,6 +767,7 @@ ODIF::ODIF_Scanner::bif_seq(void)
   {
     string n = it->name;
     string v = it->value;
+    const size_t oi = os.find( n );
     bool flag = ( atoi( v.c_str() ) > 0 );   // assign flag value
 
     if ( it->positional )
@@ -691,31 +776,31 @@ ODIF::ODIF_Scanner::bif_seq(void)
     }
     else
     {
-      if (!(n.compare(vana[0])&&n.compare(vana[1])))
+      if (oi == o_first)
       { // first
         first = atoi( unquote( v ).c_str() );
       }
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
+      else if (oi == o_incr)
       { // incr
         incr = atoi( unquote( v ).c_str() );
       }
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])))
+      else if (oi == o_last)
       { // last
         last = atoi( unquote( v ).c_str() );
       }
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])))
+      else if (oi == o_prefix)
       { // prefix
         prefix = unquote( v );
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])))
+      else if (oi == o_suffix)
       { // suffix
         suffix = unquote( v );
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])))
+      else if (oi == o_separator)
       { // separator
         wsep = unquote( v );
       }
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])))
+      else if (oi == o_format)
       { // format
         format = unquote( v );
       }
@@ -723,12 +808,11 @@ ODIF::ODIF_Scanner::bif_seq(void)
       //
       // flags
       //
-      else if (!(n.compare(vana[14])&&n.compare(vana[15])) && flag)
+      else if (oi == o_number && flag)
       { // number
         for (int seq = first; seq <= last; seq += incr)
         {
-          if ( result.size() ) result.append( wsep );
-          if ( prefix.size() ) result.append( prefix );
+          word = prefix;
 
           if ( format.size() )
           {
@@ -739,23 +823,24 @@ ODIF::ODIF_Scanner::bif_seq(void)
             {
               char buffer[bsize+1];
               snprintf(buffer, bsize+1, format.c_str(), seq);
-              result.append( buffer );
+              word.append( buffer );
             }
           }
           else
           {
-            result.append(UTIL::to_string( seq ));
+            word.append(UTIL::to_string( seq ));
           }
 
-          if ( suffix.size() ) result.append( suffix );
+          word.append( suffix );
+
+          result->append( word, result->str().empty() ? no_sep : wsep );
         }
       }
-      else if (!(n.compare(vana[16])&&n.compare(vana[17])) && flag)
+      else if (oi == o_roman && flag)
       { // roman
         for (int seq = first; seq <= last; seq += incr)
         {
-          if ( result.size() ) result.append( wsep );
-          if ( prefix.size() ) result.append( prefix );
+          word = prefix;
 
           if ( format.size() )
           {
@@ -768,15 +853,17 @@ ODIF::ODIF_Scanner::bif_seq(void)
               char buffer[bsize+1];
               snprintf(buffer, bsize+1, format.c_str(),
                        UTIL::to_roman_numeral( seq ).c_str());
-              result.append( buffer );
+              word.append( buffer );
             }
           }
           else
           {
-            result.append(UTIL::to_roman_numeral( seq ));
+            word.append(UTIL::to_roman_numeral( seq ));
           }
 
-          if ( suffix.size() ) result.append( suffix );
+          word.append( suffix );
+
+          result->append( word, result->str().empty() ? no_sep : wsep );
         }
       }
 
@@ -787,7 +874,8 @@ ODIF::ODIF_Scanner::bif_seq(void)
     }
   }
 
-  return ( result );
+  fx_list = result;
+  return ( result->release() );
 }
 
 /***************************************************************************//**
@@ -826,60 +914,54 @@ ODIF::ODIF_Scanner::bif_foreach(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_var, o_words, o_text, o_separator, o_tokenizer };
+  static constexpr opt_decl od[] =
   {
-  "var",        "v",
-  "words",      "w",
-  "text",       "t",
-  "separator",  "s",
-  "tokenizer",  "o"
+  { "var",        "v",  opt_text,  "x"  },
+  { "words",      "w",  opt_text,  ""   },
+  { "text",       "t",  opt_text,  ""   },
+  { "separator",  "s",  opt_text,  ","  },
+  { "tokenizer",  "o",  opt_text,  " ," }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
+  static const opt_schema os( od );
+  const string& help = os.help();
 
-  // assign local variable values: positions must match declaration above.
-  // do not trim to allow combining of natural language.
-  size_t ap=0;
-  string var    = unquote(fx_argv.arg_firstof( "x",vana[ap],vana[ap+1])); ap+=2;
-  string words  = unquote(fx_argv.arg_firstof(  "",vana[ap],vana[ap+1])); ap+=2;
-  string text   = unquote(fx_argv.arg_firstof(  "",vana[ap],vana[ap+1])); ap+=2;
-  string rsep   = unquote(fx_argv.arg_firstof( ",",vana[ap],vana[ap+1])); ap+=2;
-  string wtok   = unquote(fx_argv.arg_firstof(" ,",vana[ap],vana[ap+1])); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
 
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  // assign local variable values.
+  // do not trim to allow combining of natural language.
+  string var    = ov.str( o_var );
+  string text   = ov.str( o_text );
+  string rsep   = ov.str( o_separator );
+  string wtok   = ov.str( o_tokenizer );
 
   //
   // assemble result
   //
-  string result;
+  shared_ptr<word_list> result = make_shared<word_list>();
+  const string no_sep;
 
-  typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
-  boost::char_separator<char> wsep( wtok.c_str() );
-  tokenizer wl_tok( words, wsep );
+  // use the list value of words, else split the word list.
+  word_list wl;
+  if ( !fx_arg_list( ov.given( o_words ), wtok, false, wl ) )
+    wl.assign( ov.str( o_words ), wtok );
 
   // iterate over the word list, update variable, and evaluate text
-  for ( tokenizer::iterator wit=wl_tok.begin(); wit!=wl_tok.end(); ++wit )
+  for ( size_t wi=0; wi < wl.size(); ++wi )
   {
-    levm.store( var, *wit );
+    levm.store( var, wl[ wi ] );
 
-    if ( result.size() ) result.append( rsep );
-    result += levm.expand_text( text );
+    result->append( levm.expand_text( text ),
+                    result->str().empty() ? no_sep : rsep );
   }
 
-  return( result );
+  fx_list = result;
+  return( result->release() );
 }
 
 
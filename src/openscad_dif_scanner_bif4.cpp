@@ -31,7 +31,6 @@
 *******************************************************************************/
 
 #include "openscad_dif_scanner.hpp"
-#include <set>
 
 #include <boost/tokenizer.hpp>
 #include <boost/algorithm/string.hpp>
@@ -78,45 +77,38 @@ ODIF::ODIF_Scanner::bif_table(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_id, o_table_caption, o_columns, o_table_class, o_column_headings,
+         o_cell_texts, o_cell_captions, o_cell_urls };
+  static constexpr opt_decl od[] =
   {
-  "id",               "i",
-  "table_caption",    "t",
-  "columns",          "c",
-  "table_class",      "sc",
-  "column_headings",  "chl",
-  "cell_texts",       "cdl",
-  "cell_captions",    "ccl",
-  "cell_urls",        "cul"
+  { "id",               "i",    opt_trim,  "" },
+  { "table_caption",    "t",    opt_trim,  "" },
+  { "columns",          "c",    opt_trim,  "" },
+  { "table_class",      "sc",   opt_trim,  "" },
+  { "column_headings",  "chl",  opt_trim,  "" },
+  { "cell_texts",       "cdl",  opt_trim,  "" },
+  { "cell_captions",    "ccl",  opt_trim,  "" },
+  { "cell_urls",        "cul",  opt_trim,  "" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=0;
-  string id               = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string table_caption    = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string columns          = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string table_class      = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string column_headings  = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_texts       = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_captions    = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_urls        = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
-
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
+
+  // assign local variable values.
+  string id               = ov.str( o_id );
+  string table_caption    = ov.str( o_table_caption );
+  string columns          = ov.str( o_columns );
+  string table_class      = ov.str( o_table_class );
+  string column_headings  = ov.str( o_column_headings );
+  string cell_texts       = ov.str( o_cell_texts );
+  string cell_captions    = ov.str( o_cell_captions );
+  string cell_urls        = ov.str( o_cell_urls );
 
   //
   // general argument validation:
@@ -132,57 +124,45 @@ ODIF::ODIF_Scanner::bif_table(void)
     if ( is_number( columns ) )
       columns_cnt = atoi( columns.c_str() );
     else
-      return( amu_error_msg(vana[4] + "=[" + columns + "] is invalid.") );
+      return( amu_error_msg(string(od[o_columns].name) + "=[" + columns + "] is invalid.") );
   }
 
   // apply default: table_class
   if ( table_class.empty() ) table_class = "amuTable";
 
   //
-  // tokenize arguments with list members to vectors
+  // split arguments with list members, or use their list values
   //
-  typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
+  const string tsep = "~^";                 // general text separators
+  const string usep = "^|# ";               // url text separators
 
-  boost::char_separator<char> tsep("~^");   // general text separators
-  boost::char_separator<char> usep("^|# "); // url text separators
+  word_list chl_v, cdl_v, ccl_v, cul_v;
 
-  // column_headings
-  tokenizer chl_tok( column_headings, tsep );
-  vector<string> chl_v;
-  for ( tokenizer::iterator it=chl_tok.begin(); it!=chl_tok.end(); ++it )
-    chl_v.push_back( boost::trim_copy( *it ) );
+  if ( !fx_arg_list( ov.given( o_column_headings ), tsep, true, chl_v ) )
+    chl_v.assign( column_headings, tsep, true );
 
-  // cell_texts
-  tokenizer cdl_tok( cell_texts, tsep );
-  vector<string> cdl_v;
-  for ( tokenizer::iterator it=cdl_tok.begin(); it!=cdl_tok.end(); ++it )
-    cdl_v.push_back( boost::trim_copy( *it ) );
+  if ( !fx_arg_list( ov.given( o_cell_texts ), tsep, true, cdl_v ) )
+    cdl_v.assign( cell_texts, tsep, true );
 
-  // cell_captions
-  tokenizer ccl_tok( cell_captions, tsep );
-  vector<string> ccl_v;
-  for ( tokenizer::iterator it=ccl_tok.begin(); it!=ccl_tok.end(); ++it )
-    ccl_v.push_back( boost::trim_copy( *it ) );
+  if ( !fx_arg_list( ov.given( o_cell_captions ), tsep, true, ccl_v ) )
+    ccl_v.assign( cell_captions, tsep, true );
 
-  // cell_urls
-  tokenizer cul_tok( cell_urls, usep );
-  vector<string> cul_v;
-  for ( tokenizer::iterator it=cul_tok.begin(); it!=cul_tok.end(); ++it )
-    cul_v.push_back( boost::trim_copy( *it ) );
+  if ( !fx_arg_list( ov.given( o_cell_urls ), usep, true, cul_v ) )
+    cul_v.assign( cell_urls, usep, true );
 
-  // must be a heading for every column (vana[ column_headings ])
+  // must be a heading for every column (column_headings)
   if ( (chl_v.size() >0) && (chl_v.size() != columns_cnt) )
-    return( amu_error_msg("mismatched " + vana[8] + ": " + to_string(chl_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_column_headings].name) + ": " + to_string(chl_v.size()) +
                           " headings for " + to_string(columns_cnt) + " columns.") );
 
-  // must be a caption for every cell (vana[ cell_captions ])
+  // must be a caption for every cell (cell_captions)
   if ( (ccl_v.size() >0) && (ccl_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[12] + ": " + to_string(ccl_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_captions].name) + ": " + to_string(ccl_v.size()) +
                           " captions for " + to_string(cdl_v.size()) + " cells.") );
 
-  // must be a url for every cell (vana[ cell_urls ])
+  // must be a url for every cell (cell_urls)
   if ( (cul_v.size() >0) && (cul_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[14] + ": " + to_string(cul_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_urls].name) + ": " + to_string(cul_v.size()) +
                           " URLs for " + to_string(cdl_v.size()) + " cells.") );
 
 
@@ -221,11 +201,8 @@ ODIF::ODIF_Scanner::bif_table(void)
   }
 
   // iterate over cells
-  int cdl_num = 0;
-  for ( vector<string>::const_iterator it=cdl_v.begin(); it!=cdl_v.end(); ++it )
+  for ( size_t cdl_num=0; cdl_num < cdl_v.size(); ++cdl_num )
   {
-    const string text = *it;
-
     // check new row
     if ( (cdl_num%columns_cnt) == 0 ) {
       // cell captions
@@ -251,7 +228,7 @@ ODIF::ODIF_Scanner::bif_table(void)
         + file_rl( cul_v[cdl_num], get_html_output(), found )
         + "\">" );
 
-    result.append( text );
+    cdl_v.append_to( cdl_num, result );
 
     if ( cell_urls.length() ) result.append("</a>");
 
@@ -264,8 +241,6 @@ ODIF::ODIF_Scanner::bif_table(void)
       result.append("</tr>");
       IDINL;
     }
-
-    cdl_num++;
   }
 
   // end table
@@ -319,49 +294,42 @@ ODIF::ODIF_Scanner::bif_image(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_type, o_caption, o_class, o_width, o_height, o_begin, o_end,
+         o_file, o_title, o_url };
+  static constexpr opt_decl od[] =
   {
-  "type",     "o",
-  "caption",  "c",
-  "class",    "d",
-  "width",    "w",
-  "height",   "h",
-  "begin",    "b",
-  "end",      "e",
-  "file",     "f",
-  "title",    "t",
-  "url",      "u",
+  { "type",     "o",  opt_trim,  "html"  },
+  { "caption",  "c",  opt_trim,  ""      },
+  { "class",    "d",  opt_trim,  "image" },
+  { "width",    "w",  opt_trim,  ""      },
+  { "height",   "h",  opt_trim,  ""      },
+  { "begin",    "b",  opt_trim,  ""      },
+  { "end",      "e",  opt_trim,  ""      },
+  { "file",     "f",  opt_trim,  ""      },
+  { "title",    "t",  opt_trim,  ""      },
+  { "url",      "u",  opt_trim,  ""      }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=0;
-  string type       = unquote_trim(fx_argv.arg_firstof("html"  ,vana[ap],vana[ap+1])); ap+=2;
-  string caption    = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string div_class  = unquote_trim(fx_argv.arg_firstof("image" ,vana[ap],vana[ap+1])); ap+=2;
-  string width      = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string height     = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string div_begin  = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string div_end    = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string file       = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string title      = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-  string url        = unquote_trim(fx_argv.arg_firstof(""      ,vana[ap],vana[ap+1])); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
-
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
+
+  // assign local variable values.
+  string type       = ov.str( o_type );
+  string caption    = ov.str( o_caption );
+  string div_class  = ov.str( o_class );
+  string width      = ov.str( o_width );
+  string height     = ov.str( o_height );
+  string div_begin  = ov.str( o_begin );
+  string div_end    = ov.str( o_end );
+  string file       = ov.str( o_file );
+  string title      = ov.str( o_title );
+  string url        = ov.str( o_url );
 
   //
   // general argument validation:
@@ -494,57 +462,52 @@ ODIF::ODIF_Scanner::bif_image_table(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_type, o_id, o_table_caption, o_columns, o_table_class,
+         o_image_width, o_image_height, o_column_headings, o_cell_begin,
+         o_cell_end, o_cell_files, o_cell_titles, o_cell_captions,
+         o_cell_urls };
+  static constexpr opt_decl od[] =
   {
-  "type",             "f",
-  "id",               "i",
-  "table_caption",    "t",
-  "columns",          "c",
-  "table_class",      "sc",
-  "image_width",      "iw",
-  "image_height",     "ih",
-  "column_headings",  "chl",
-  "cell_begin",       "cdb",
-  "cell_end",         "cde",
-  "cell_files",       "cdl",
-  "cell_titles",      "ctl",
-  "cell_captions",    "ccl",
-  "cell_urls",        "cul"
+  { "type",             "f",    opt_trim,  "" },
+  { "id",               "i",    opt_trim,  "" },
+  { "table_caption",    "t",    opt_trim,  "" },
+  { "columns",          "c",    opt_trim,  "" },
+  { "table_class",      "sc",   opt_trim,  "" },
+  { "image_width",      "iw",   opt_trim,  "" },
+  { "image_height",     "ih",   opt_trim,  "" },
+  { "column_headings",  "chl",  opt_trim,  "" },
+  { "cell_begin",       "cdb",  opt_trim,  "" },
+  { "cell_end",         "cde",  opt_trim,  "" },
+  { "cell_files",       "cdl",  opt_trim,  "" },
+  { "cell_titles",      "ctl",  opt_trim,  "" },
+  { "cell_captions",    "ccl",  opt_trim,  "" },
+  { "cell_urls",        "cul",  opt_trim,  "" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=0;
-  string type             = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string id               = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string table_caption    = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string columns          = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string table_class      = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string image_width      = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string image_height     = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string column_headings  = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_begin       = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_end         = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_files       = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_titles      = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_captions    = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string cell_urls        = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
-
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
+
+  // assign local variable values.
+  string type             = ov.str( o_type );
+  string id               = ov.str( o_id );
+  string table_caption    = ov.str( o_table_caption );
+  string columns          = ov.str( o_columns );
+  string table_class      = ov.str( o_table_class );
+  string image_width      = ov.str( o_image_width );
+  string image_height     = ov.str( o_image_height );
+  string column_headings  = ov.str( o_column_headings );
+  string cell_begin       = ov.str( o_cell_begin );
+  string cell_end         = ov.str( o_cell_end );
+  string cell_files       = ov.str( o_cell_files );
+  string cell_titles      = ov.str( o_cell_titles );
+  string cell_captions    = ov.str( o_cell_captions );
+  string cell_urls        = ov.str( o_cell_urls );
 
   //
   // general argument validation:
@@ -555,7 +518,7 @@ ODIF::ODIF_Scanner::bif_image_table(void)
     return(amu_error_msg("requires zero positional argument. " + help));
 
   // required arguments: type must exists and be one of 'html' or 'latex'
-  if ( ! fx_argv.exists( vana[0] ) && ! fx_argv.exists( vana[1] ) )
+  if ( ! ov.found( o_type ) )
     return( amu_error_msg("table type must be specified. may be (html|latex).") );
   else if ( type.compare("html") && type.compare("latex") )
     return( amu_error_msg( "type " + type + " is invalid. may be (html|latex).") );
@@ -566,7 +529,7 @@ ODIF::ODIF_Scanner::bif_image_table(void)
     if ( is_number( columns ) )
       columns_cnt = atoi( columns.c_str() );
     else
-      return( amu_error_msg(vana[6] + "=[" + columns + "] is invalid.") );
+      return( amu_error_msg(string(od[o_columns].name) + "=[" + columns + "] is invalid.") );
   }
 
   // apply default: table_class
@@ -623,34 +586,34 @@ ODIF::ODIF_Scanner::bif_image_table(void)
   for ( tokenizer::iterator it=cul_tok.begin(); it!=cul_tok.end(); ++it )
     cul_v.push_back( boost::trim_copy( *it ) );
 
-  // must be a heading for every column (vana[ column_headings ])
+  // must be a heading for every column (column_headings)
   if ( (chl_v.size() >0) && (chl_v.size() != columns_cnt) )
-    return( amu_error_msg("mismatched " + vana[14] + ": " + to_string(chl_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_column_headings].name) + ": " + to_string(chl_v.size()) +
                           " headings for " + to_string(columns_cnt) + " columns.") );
 
-  // must be a begin for every cell (vana[ cell_begin ])
+  // must be a begin for every cell (cell_begin)
   if ( (cdb_v.size() >0) && (cdb_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[16] + ": " + to_string(cdb_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_begin].name) + ": " + to_string(cdb_v.size()) +
                           " begins for " + to_string(cdl_v.size()) + " cells.") );
 
-  // must be an end for every cell (vana[ cell_end ])
+  // must be an end for every cell (cell_end)
   if ( (cde_v.size() >0) && (cde_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[18] + ": " + to_string(cde_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_end].name) + ": " + to_string(cde_v.size()) +
                           " ends for " + to_string(cdl_v.size()) + " cells.") );
 
-  // must be a title for every cell (vana[ cell_titles ])
+  // must be a title for every cell (cell_titles)
   if ( (ctl_v.size() >0) && (ctl_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[22] + ": " + to_string(ctl_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_titles].name) + ": " + to_string(ctl_v.size()) +
                           " titles for " + to_string(cdl_v.size()) + " cells.") );
 
-  // must be a caption for every cell (vana[ cell_captions ])
+  // must be a caption for every cell (cell_captions)
   if ( (ccl_v.size() >0) && (ccl_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[24] + ": " + to_string(ccl_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_captions].name) + ": " + to_string(ccl_v.size()) +
                           " captions for " + to_string(cdl_v.size()) + " cells.") );
 
-  // must be a url for every cell (vana[ cell_urls ])
+  // must be a url for every cell (cell_urls)
   if ( (cul_v.size() >0) && (cul_v.size() != cdl_v.size()) )
-    return( amu_error_msg("mismatched " + vana[26] + ": " + to_string(cul_v.size()) +
+    return( amu_error_msg("mismatched " + string(od[o_cell_urls].name) + ": " + to_string(cul_v.size()) +
                           " URLs for " + to_string(cdl_v.size()) + " cells.") );
 
 
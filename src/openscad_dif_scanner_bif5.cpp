@@ -31,7 +31,6 @@
 *******************************************************************************/
 
 #include "openscad_dif_scanner.hpp"
-#include <set>
 
 // #include <boost/filesystem.hpp>
 
@@ -254,6 +253,19 @@ ODIF::ODIF_Scanner::bif_if_exp_2a(string s)
       shfile    | sf  | false   | show script file with command arguments
       shbin     | sb  | true    | show openscad bin with command arguments
       debug     | g   | false   | include command debug infomation
+      cache     | k   | true    | use the result cache (when configured)
+
+    Resource limits (zero means no limit):
+
+     options    | sc  | default | description
+    :----------:|:---:|:-------:|:-----------------------------------------
+      timeout   | to  | 0       | wall-clock time limit in seconds
+      cpu       | cpu | 0       | processor time limit in seconds
+      mem       | mem | 0       | address space limit in MiB
+
+    When a limit is not specified, the value set on the command line is
+    used. A script that exceeds a limit is terminated and an error is
+    reported in place of its output.
 
     Flags that produce output:
 
@@ -328,6 +340,28 @@ ODIF::ODIF_Scanner::bif_if_exp_2a(string s)
               will only be constructed or updated when their dependency
               changes.
 
+    When the filter is started with <tt>--jobs N</tt>, where N is
+    greater than one, in-line scripts whose result is written to the
+    output (not stored to a variable) are run concurrently on a pool of
+    at most N commands. A placeholder is kept in the output stream for
+    each script, and the formatted results are written in their
+    original order once each completes, so that the output is identical
+    to that of sequential operation. Scripts are always run
+    sequentially when filter debugging is enabled. Each script without
+    a named \c file is written to its own temporary file; a script that
+    names the \c file of a script that is still running waits for it
+    to complete before the file is rewritten.
+
+    When the configuration option \c openscad-cache names a directory,
+    the console output of each successful script is saved there, keyed
+    by the script text, \c args, the script \c file name (when
+    specified), the identity (path, size, and modification time) of the
+    OpenSCAD executable, and of each file it includes or uses. A later
+    call with the same key reuses the saved output, in place of running
+    OpenSCAD, provided each output file named by \c -o in \c args
+    exists. The \c rmecho and output formatting options are applied as
+    usual. Use the \c cache flag to disable this for a single script.
+
     For more information on how to specify and use function arguments
     see \ref openscad_dif_sm_a.
 *******************************************************************************/
@@ -336,66 +370,69 @@ ODIF::ODIF_Scanner::bif_openscad(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_file, o_args, o_format_command, o_format_script,
+         o_format_console, o_rmecho, o_rmfile, o_shfile, o_shbin, o_debug,
+         o_cache, o_timeout, o_cpu, o_mem,
+         o_command, o_script, o_console };
+  static constexpr opt_decl od[] =
   {
-  "file",             "f",
-  "args",             "a",
-
-  "format_command",   "fx",
-  "format_script",    "fp",
-  "format_console",   "fc",
-
-  "rmecho",           "o",
-  "rmfile",           "d",
-  "shfile",           "sf",
-  "shbin",            "sb",
-  "debug",            "g",
-
-  "command",          "x",
-  "script",           "p",
-  "console",          "c"
+  { "file",            "f",   opt_trim,  "" },
+  { "args",            "a",   opt_text,  "" },
+
+  { "format_command",  "fx",  opt_text,  "2,\\code,\\endcode,4,<b>Command</b>" },
+  { "format_script",   "fp",  opt_text,  "2,\\code{.C},\\endcode,4,<b>Script</b>" },
+  { "format_console",  "fc",  opt_text,  "2,\\verbatim,\\endverbatim,4,<b>Output</b>" },
+
+  { "rmecho",          "o",   opt_flag,  "0" },
+  { "rmfile",          "d",   opt_flag,  "1" },
+  { "shfile",          "sf",  opt_flag,  "0" },
+  { "shbin",           "sb",  opt_flag,  "1" },
+  { "debug",           "g",   opt_flag,  "0" },
+  { "cache",           "k",   opt_flag,  "1" },
+
+  { "timeout",         "to",  opt_int,   "0" },
+  { "cpu",             "cpu", opt_int,   "0" },
+  { "mem",             "mem", opt_int,   "0" },
+
+  { "command",         "x",   opt_flag,  "0" },
+  { "script",          "p",   opt_flag,  "0" },
+  { "console",         "c",   opt_flag,  "0" }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
+  static const opt_schema os( od );
+  const string& help = os.help();
+
+  // parse named arguments: (must be one of the declared options).
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + " invalid option. " + help) );
 
   // output format defaults
-  string fmt_cmd_def = "2,\\code,\\endcode,4,<b>Command</b>";
-  string fmt_scr_def = "2,\\code{.C},\\endcode,4,<b>Script</b>";
-  string fmt_con_def = "2,\\verbatim,\\endverbatim,4,<b>Output</b>";
-
-  // assign local variable values: positions must match declaration above.
-  size_t ap=0;
-  string file           = unquote_trim(fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-  string args           = unquote     (fx_argv.arg_firstof("",vana[ap],vana[ap+1])); ap+=2;
-
-  string fmt_cmd        = unquote     (fx_argv.arg_firstof(fmt_cmd_def,vana[ap],vana[ap+1])); ap+=2;
-  string fmt_scr        = unquote     (fx_argv.arg_firstof(fmt_scr_def,vana[ap],vana[ap+1])); ap+=2;
-  string fmt_con        = unquote     (fx_argv.arg_firstof(fmt_con_def,vana[ap],vana[ap+1])); ap+=2;
-
-  bool rmecho   = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool rmfile   = ( atoi( unquote_trim(fx_argv.arg_firstof("1",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool shfile   = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool shbin    = ( atoi( unquote_trim(fx_argv.arg_firstof("1",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool debug    = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  bool command  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool script   = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-  bool console  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[ap],vana[ap+1])).c_str() ) > 0 ); ap+=2;
-
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
+  const string fmt_cmd_def = od[o_format_command].dv;
+  const string fmt_scr_def = od[o_format_script].dv;
+  const string fmt_con_def = od[o_format_console].dv;
+
+  // assign local variable values.
+  string file           = ov.str( o_file );
+  string args           = ov.str( o_args );
+
+  string fmt_cmd        = ov.str( o_format_command );
+  string fmt_scr        = ov.str( o_format_script );
+  string fmt_con        = ov.str( o_format_console );
+
+  bool rmecho   = ov.flag( o_rmecho );
+  bool rmfile   = ov.flag( o_rmfile );
+  bool shfile   = ov.flag( o_shfile );
+  bool shbin    = ov.flag( o_shbin );
+  bool debug    = ov.flag( o_debug );
+  bool cache    = ov.flag( o_cache );
 
-  // validate named arguments: (must be one of the declared options).
-  vector<string> av = fx_argv.names_v(true, false);
-  for ( vector<string>::iterator it=av.begin(); it!=av.end(); ++it )
-    if ( vans.find( *it ) == vans.end() )
-      return( amu_error_msg(*it + " invalid option. " + help) );
+  bool command  = ov.flag( o_command );
+  bool script   = ov.flag( o_script );
+  bool console  = ov.flag( o_console );
+
+  const UTIL::proc_limits pl = limits_option( ov, o_timeout, o_cpu, o_mem );
 
   //
   // general argument validation:
@@ -408,6 +445,9 @@ ODIF::ODIF_Scanner::bif_openscad(void)
   // start debug
   filter_debug( "amu_" + fx_argv.arg(0) + " begin.", true, false );
 
+  // script file name when specified
+  const string named_file = file;
+
   // when file is not specified create unique temporary file name
   if ( file.empty() )
   {
@@ -422,6 +462,38 @@ ODIF::ODIF_Scanner::bif_openscad(void)
     filter_debug( "temp_file: " + file, false, false );
   }
 
+  // cache key: script, arguments, binary, and resolved dependencies
+  string cache_key;
+
+  if ( ( cache && openscad_cache.enabled() ) || !get_depfile().empty() )
+  {
+    string deps;
+
+    vector<string> lib;
+    if ( getenv("OPENSCADPATH") != NULL )
+      lib = string_tokenize_to_vector( getenv("OPENSCADPATH"), ":" );
+
+    set<string> visited;
+    string dir = bfs::path( file ).parent_path().string();
+    openscad_depends( fx_body_text, dir.empty() ? "." : dir, lib, deps, visited );
+
+    // included and used files are dependencies of the output
+    for ( set<string>::const_iterator it=visited.begin(); it!=visited.end(); ++it )
+      add_depend( *it );
+
+    if ( cache && openscad_cache.enabled() )
+      cache_key = "amu_openscad\n"
+                + file_identity( get_openscad_path() ) + "\n"
+                + args + "\n"
+                + named_file + "\n"
+                + fx_body_text + "\n"
+                + deps;
+  }
+
+  // a named script file may still be in use by a deferred script
+  if ( !named_file.empty() && defer_uses( file ) )
+    defer_barrier();
+
   // create script file
   ofstream ofs ( file.c_str() );
   if ( ofs.is_open() )
@@ -444,109 +516,136 @@ ODIF::ODIF_Scanner::bif_openscad(void)
 
   filter_debug( "issuing command: " + command_string, false, false );
 
-  string command_output;
-  bool command_good = false;
+  // use cached output when each named output file exists
+  string cache_output;
+  bool cache_good = false;
 
-  // issue system command
-  UTIL::sys_command( command_string, command_output, command_good, true, false );
+  const bool cache_hit = !cache_key.empty() && openscad_outputs_exist( args )
+                       && openscad_cache.get( cache_key, cache_output, cache_good );
 
-  filter_debug( "command return: " + string(command_good?"ok":"fail"), false, false );
+  if ( cache_hit )
+    filter_debug( "using cached result", false, false );
 
-  // remove script file
-  if ( rmfile )
-  {
-    if ( bfs::exists(file) && bfs::is_regular_file(file) )
+  // indent path to same indentation as 'args'
+  const string openscad = indent_line( get_openscad_path(), get_indent(args) );
+  const string body_text = fx_body_text;
+  const string error_loc = amu_error_loc();
+
+  // format command output (now or, when deferred, once command completes)
+  defer_fmt format_output =
+    [=] (string& command_output, bool command_good) -> string
     {
-      filter_debug( "removing file: " + file, false, false );
+      filter_debug( "command return: " + string(command_good?"ok":"fail"), false, false );
 
-      bfs::remove(file);
-    }
-  }
+      // save raw console output for subsequent runs
+      if ( command_good && !cache_key.empty() && !cache_hit )
+        openscad_cache.put( cache_key, command_output, command_good );
 
-  // remove script first in case of return on error
-  if ( !command_good )
-    return( amu_error_msg( "unable to execute command: " + command_string ) );
+      // remove script file
+      if ( rmfile )
+      {
+        if ( bfs::exists(file) && bfs::is_regular_file(file) )
+        {
+          filter_debug( "removing file: " + file, false, false );
 
-  // remove OpenSCAD quoted [ECHO: "..."]
-  if ( rmecho )
-  {
-    filter_debug( "removing output echo...", false, false );
+          bfs::remove(file);
+        }
+      }
 
-    command_output = openscad_rmecho_text( command_output );
-  }
+      // remove script first in case of return on error
+      if ( !command_good )
+        return( amu_error_msg( command_output.empty()
+                               ? "unable to execute command: " + command_string
+                               : command_output, error_loc ) );
 
-  // remove escape character before debug output
-  filter_debug( "format_command [" + replace_chars(fmt_cmd,"\\", 'X') + "]", false, false );
-  filter_debug( " format_script [" + replace_chars(fmt_scr,"\\", 'X') + "]", false, false );
-  filter_debug( "format_console [" + replace_chars(fmt_con,"\\", 'X') + "]", false, false );
+      // remove OpenSCAD quoted [ECHO: "..."]
+      if ( rmecho )
+      {
+        filter_debug( "removing output echo...", false, false );
 
-  // start results on newline
-  string result = "\n";
+        command_output = openscad_rmecho_text( command_output );
+      }
 
-  // include command debug infomation
-  if ( debug )
-  {
-    result += indent_text("\n\\verbatim\n" + command_string + "\n\\endverbatim\n\n", 4);
-  }
+      // remove escape character before debug output
+      filter_debug( "format_command [" + replace_chars(fmt_cmd,"\\", 'X') + "]", false, false );
+      filter_debug( " format_script [" + replace_chars(fmt_scr,"\\", 'X') + "]", false, false );
+      filter_debug( "format_console [" + replace_chars(fmt_con,"\\", 'X') + "]", false, false );
 
-  // append command line arguments to result
-  if ( command )
-  {
-    int    oi = atoi( get_field( 0, fmt_cmd, fmt_cmd_def ).c_str() );
-    string po =       get_field( 1, fmt_cmd, fmt_cmd_def );
-    string oo =       get_field( 2, fmt_cmd, fmt_cmd_def );
-    int    ti = atoi( get_field( 3, fmt_cmd, fmt_cmd_def ).c_str() );
-    string tt =       get_field( 4, fmt_cmd, fmt_cmd_def );
-
-    // indent path to same indentation as 'args'
-    string openscad = indent_line( get_openscad_path(), get_indent(args) );
-
-    if ( !tt.empty() ) { result += indent_line(tt + "\n", ti); }
-    if ( !po.empty() ) { result += indent_line(po + "\n", ti); }
-
-                         result += indent_text
-                                   (
-                                       (shbin?(openscad + " "):"")
-                                     + args
-                                     + (shfile?(" " + file):""), oi
-                                   );
-
-    if ( !oo.empty() ) { result += indent_line(oo + "\n", ti); }
-  }
+      // start results on newline
+      string result = "\n";
 
-  // append in-line script to result
-  if ( script )
-  {
-    int    oi = atoi( get_field( 0, fmt_scr, fmt_scr_def ).c_str() );
-    string po =       get_field( 1, fmt_scr, fmt_scr_def );
-    string oo =       get_field( 2, fmt_scr, fmt_scr_def );
-    int    ti = atoi( get_field( 3, fmt_scr, fmt_scr_def ).c_str() );
-    string tt =       get_field( 4, fmt_scr, fmt_scr_def );
+      // include command debug infomation
+      if ( debug )
+      {
+        result += indent_text("\n\\verbatim\n" + command_string + "\n\\endverbatim\n\n", 4);
+      }
 
-    if ( !tt.empty() ) { result += indent_line(tt + "\n", ti); }
-    if ( !po.empty() ) { result += indent_line(po + "\n", ti); }
+      // append command line arguments to result
+      if ( command )
+      {
+        int    oi = atoi( get_field( 0, fmt_cmd, fmt_cmd_def ).c_str() );
+        string po =       get_field( 1, fmt_cmd, fmt_cmd_def );
+        string oo =       get_field( 2, fmt_cmd, fmt_cmd_def );
+        int    ti = atoi( get_field( 3, fmt_cmd, fmt_cmd_def ).c_str() );
+        string tt =       get_field( 4, fmt_cmd, fmt_cmd_def );
+
+        if ( !tt.empty() ) { result += indent_line(tt + "\n", ti); }
+        if ( !po.empty() ) { result += indent_line(po + "\n", ti); }
+
+                             result += indent_text
+                                       (
+                                           (shbin?(openscad + " "):"")
+                                         + args
+                                         + (shfile?(" " + file):""), oi
+                                       );
+
+        if ( !oo.empty() ) { result += indent_line(oo + "\n", ti); }
+      }
 
-                         result += indent_text(fx_body_text, oi);
+      // append in-line script to result
+      if ( script )
+      {
+        int    oi = atoi( get_field( 0, fmt_scr, fmt_scr_def ).c_str() );
+        string po =       get_field( 1, fmt_scr, fmt_scr_def );
+        string oo =       get_field( 2, fmt_scr, fmt_scr_def );
+        int    ti = atoi( get_field( 3, fmt_scr, fmt_scr_def ).c_str() );
+        string tt =       get_field( 4, fmt_scr, fmt_scr_def );
 
-    if ( !oo.empty() ) { result += indent_line(oo + "\n", ti); }
-  }
+        if ( !tt.empty() ) { result += indent_line(tt + "\n", ti); }
+        if ( !po.empty() ) { result += indent_line(po + "\n", ti); }
 
-  // append script console output to result
-  if ( console )
-  {
-    int    oi = atoi( get_field( 0, fmt_con, fmt_con_def ).c_str() );
-    string po =       get_field( 1, fmt_con, fmt_con_def );
-    string oo =       get_field( 2, fmt_con, fmt_con_def );
-    int    ti = atoi( get_field( 3, fmt_con, fmt_con_def ).c_str() );
-    string tt =       get_field( 4, fmt_con, fmt_con_def );
+                             result += indent_text(body_text, oi);
 
-    if ( !tt.empty() ) { result += indent_line(tt + "\n", ti); }
-    if ( !po.empty() ) { result += indent_line(po + "\n", ti); }
+        if ( !oo.empty() ) { result += indent_line(oo + "\n", ti); }
+      }
+
+      // append script console output to result
+      if ( console )
+      {
+        int    oi = atoi( get_field( 0, fmt_con, fmt_con_def ).c_str() );
+        string po =       get_field( 1, fmt_con, fmt_con_def );
+        string oo =       get_field( 2, fmt_con, fmt_con_def );
+        int    ti = atoi( get_field( 3, fmt_con, fmt_con_def ).c_str() );
+        string tt =       get_field( 4, fmt_con, fmt_con_def );
 
-                         result += indent_text(command_output, oi);
+        if ( !tt.empty() ) { result += indent_line(tt + "\n", ti); }
+        if ( !po.empty() ) { result += indent_line(po + "\n", ti); }
 
-    if ( !oo.empty() ) { result += indent_line(oo + "\n", ti); }
-  }
+                             result += indent_text(command_output, oi);
+
+        if ( !oo.empty() ) { result += indent_line(oo + "\n", ti); }
+      }
+
+      return( result );
+    };
+
+  string result;
+
+  if ( cache_hit )
+    result = format_output( cache_output, cache_good );
+  else // issue system command
+    result = run_command( command_string, true, false, format_output,
+                          true, &pl, file );
 
   // end debug
   filter_debug( "amu_" + fx_argv.arg(0) + " end.", false, true );
@@ -599,38 +698,37 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
 {
   using namespace UTIL;
 
-  // options declaration: vana & vans.
-  // !!DO NOT REORDER WITHOUT UPDATING POSITIONAL DEPENDENCIES BELOW!!
-  string vana[] =
+  // options declaration.
+  enum { o_verbose,
+         o_parent, o_mkrel, o_mkrelp, o_mkdir, o_mkdirp,
+         o_uuid };
+  static constexpr opt_decl od[] =
   {
-  "verbose",  "v",
+  { "verbose",  "v",    opt_flag,   "0" },
 
-  "parent",   "p",
-  "mkrel",    "mr",
-  "mkrelp",   "mrp",
-  "mkdir",    "md",
-  "mkdirp",   "mdp",
+  { "parent",   "p",    opt_trim,   ""  },
+  { "mkrel",    "mr",   opt_trim,   ""  },
+  { "mkrelp",   "mrp",  opt_trim,   ""  },
+  { "mkdir",    "md",   opt_trim,   ""  },
+  { "mkdirp",   "mdp",  opt_trim,   ""  },
 
-  "uuid",     "u"
+  { "uuid",     "u",    opt_flag,   ""  }
   };
-  set<string> vans(vana, vana + sizeof(vana)/sizeof(string));
+  static const opt_schema os( od );
+  const string& help = os.help();
 
-  // assign local variable values: positions must match declaration above.
-  size_t ap=14;
-  bool verbose  = ( atoi( unquote_trim(fx_argv.arg_firstof("0",vana[0],vana[1])).c_str() ) > 0 );
+  // assign control flags; other options are processed in order below.
+  opt_values ov;
+  const func_args::arg_term* bad;
+  if ( !os.parse( fx_argv, ov, bad ) )
+    return( amu_error_msg(bad->name + "=" + bad->value + " invalid option. " + help) );
+
+  bool verbose  = ov.flag( o_verbose );
   bfs::path parent;
 
   // tokenizer delimiters
   string toks = ", ";
 
-  // generate options help string.
-  string help = "options: [";
-  for(size_t it=0; it < ap; it+=2) {
-    if (it) help.append( ", " );
-    help.append( vana[it] + " (" + vana[it+1] + ")" );
-  }
-  help.append( "]" );
-
   string result;
 
   // iterate over the arguments, skipping function name (position zero)
@@ -640,6 +738,7 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
   {
     string n = it->name;
     string v = unquote_trim(it->value);
+    const size_t oi = os.find( n );
     bool flag = ( atoi( v.c_str() ) > 0 );   // assign flag value
 
     if ( it->positional )
@@ -649,16 +748,16 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
     else
     {
       if      (
-                !(n.compare(vana[0])&&n.compare(vana[1]))     // verbose
+                oi == o_verbose
               )
       {
         // do nothing, control flags values set above.
       }
-      else if (!(n.compare(vana[2])&&n.compare(vana[3])))
+      else if (oi == o_parent)
       { // parent
         parent = v;
       }
-      else if (!(n.compare(vana[4])&&n.compare(vana[5])))
+      else if (oi == o_mkrel)
       { // mkrel
         vector<string> vv = string_tokenize_to_vector(v, toks);
 
@@ -673,7 +772,7 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
           );
         }
       }
-      else if (!(n.compare(vana[6])&&n.compare(vana[7])))
+      else if (oi == o_mkrelp)
       { // mkrelp
         vector<string> vv = string_tokenize_to_vector(v, toks);
 
@@ -688,7 +787,7 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
           );
         }
       }
-      else if (!(n.compare(vana[8])&&n.compare(vana[9])))
+      else if (oi == o_mkdir)
       { // mkdir
         vector<string> vv = string_tokenize_to_vector(v, toks);
 
@@ -705,7 +804,7 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
           if ( verbose || !ok ) result.append( (result.empty()?"":", ") + m );
         }
       }
-      else if (!(n.compare(vana[10])&&n.compare(vana[11])))
+      else if (oi == o_mkdirp)
       { // mkdirp
         vector<string> vv = string_tokenize_to_vector(v, toks);
 
@@ -723,7 +822,7 @@ ODIF::ODIF_Scanner::bif_filesystem(void)
         }
       }
 
-      else if (!(n.compare(vana[12])&&n.compare(vana[13])) && flag)
+      else if (oi == o_uuid && flag)
       { // uuid
         result.append
         (
@@ -40,10 +40,62 @@
 #include <boost/regex.hpp>
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+
 #if defined(HAVE_CONFIG_H)
 #include "config.h"
 #endif
 
+#if defined(HAVE_FORK) && defined(HAVE_PIPE)
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <errno.h>
+#endif
+
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+#if defined(HAVE_GETRUSAGE) || defined(HAVE_SETRLIMIT)
+#include <sys/resource.h>
+#endif
+
+#if defined(HAVE_POLL)
+#include <poll.h>
+#endif
+
+// vector character scan kernels (selected at run time, see simd_supported)
+#if ( defined(__x86_64__) || defined(__i386__) ) && defined(__GNUC__)
+#define ODIF_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(HAVE_MMAP)
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(HAVE_FLOCK)
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#if defined(HAVE_LINUX_FS_H) && defined(HAVE_SYS_IOCTL_H)
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 using namespace std;
 
 
@@ -51,11 +103,18 @@ using namespace std;
 // ODIF::env_var
 ////////////////////////////////////////////////////////////////////////////////
 
+const size_t ODIF::env_var::npos;
+
+size_t ODIF::env_var::lookup_count = 0;
+size_t ODIF::env_var::store_count = 0;
+size_t ODIF::env_var::reuse_count = 0;
+
 ODIF::env_var::env_var( const string& p, const string& s,
                         const string& e, const string& ep,
                         const string& es,
                         const size_t& epl, const size_t& esl,
                         bool r, const string& rm)
+  : live_count(0), arena_waste(0)
 {
   set_prefix( p );
   set_suffix( s );
@@ -73,6 +132,168 @@ ODIF::env_var::~env_var( void )
   clear();
 }
 
+void
+ODIF::env_var::clear(void)
+{
+  slots.clear();
+  entries.clear();
+  arena.clear();
+
+  live_count = 0;
+  arena_waste = 0;
+}
+
+size_t
+ODIF::env_var::find_slot(const char* n, const size_t l, const size_t h) const
+{
+  // linear probing; table size is a power of two and never full.
+  const size_t mask = slots.size() - 1;
+
+  for ( size_t i = h & mask; ; i = (i+1) & mask )
+  {
+    const size_t ei = slots[i];
+
+    if ( ei == npos )
+      return ( i );
+
+    const entry_s& e = entries[ ei ];
+    if ( e.hash == h && e.key_len == l &&
+         arena.compare(e.key_off, l, n, l) == 0 )
+      return ( i );
+  }
+}
+
+size_t
+ODIF::env_var::find(const char* n, const size_t l)
+{
+  ++lookup_count;
+
+  if ( slots.empty() )
+    return ( npos );
+
+  const size_t ei = slots[ find_slot(n, l, UTIL::hash_fnv1a(n, l)) ];
+
+  if ( ei == npos || !entries[ ei ].live )
+    return ( npos );
+
+  return ( ei );
+}
+
+void
+ODIF::env_var::rehash(const size_t c)
+{
+  slots.assign( c, npos );
+
+  for ( size_t ei = 0; ei < entries.size(); ++ei )
+  {
+    const entry_s& e = entries[ ei ];
+    slots[ find_slot(arena.data()+e.key_off, e.key_len, e.hash) ] = ei;
+  }
+}
+
+void
+ODIF::env_var::compact(void)
+{
+  string na;
+  na.reserve( arena.size() - arena_waste );
+
+  for ( vector<entry_s>::iterator it=entries.begin(); it!=entries.end(); ++it )
+  {
+    const size_t ko = na.size();
+    na.append( arena, it->key_off, it->key_len );
+    it->key_off = ko;
+
+    const size_t vo = na.size();
+    na.append( arena, it->val_off, it->val_len );
+    it->val_off = vo;
+    it->val_cap = it->val_len;
+  }
+
+  arena.swap( na );
+  arena_waste = 0;
+}
+
+void
+ODIF::env_var::store(const string& n, const string& v)
+{
+  ++store_count;
+
+  // keep load factor below 3/4.
+  if ( (entries.size() + 1) * 4 > slots.size() * 3 )
+    rehash( slots.empty() ? 64 : slots.size() * 2 );
+
+  const size_t h = UTIL::hash_fnv1a( n );
+  const size_t si = find_slot( n.data(), n.length(), h );
+
+  if ( slots[ si ] == npos )
+  {
+    // intern new variable name with value.
+    entry_s e;
+
+    e.hash = h;
+    e.key_off = arena.size();
+    e.key_len = n.length();
+    arena.append( n );
+
+    e.val_off = arena.size();
+    e.val_len = e.val_cap = v.length();
+    e.val_gen = store_count;
+    arena.append( v );
+
+    e.live = true;
+
+    slots[ si ] = entries.size();
+    entries.push_back( e );
+    ++live_count;
+
+    return;
+  }
+
+  entry_s& e = entries[ slots[ si ] ];
+
+  e.val_gen = store_count;
+
+  if ( !e.live )
+  {
+    e.live = true;
+    ++live_count;
+  }
+
+  if ( v.length() <= e.val_cap )
+  {
+    // overwrite value in place.
+    arena.replace( e.val_off, v.length(), v );
+    e.val_len = v.length();
+    ++reuse_count;
+  }
+  else
+  {
+    // abandon old buffer and append value.
+    arena_waste += e.val_cap;
+
+    e.val_off = arena.size();
+    e.val_len = e.val_cap = v.length();
+    arena.append( v );
+
+    if ( arena_waste > 4096 && arena_waste * 2 > arena.size() )
+      compact();
+  }
+}
+
+void
+ODIF::env_var::erase(const string& n)
+{
+  // the interned name remains to be reused when variable is redefined.
+  const size_t ei = find( n.data(), n.length() );
+
+  if ( ei != npos )
+  {
+    entries[ ei ].live = false;
+    entries[ ei ].val_len = 0;
+    --live_count;
+  }
+}
+
 string
 ODIF::env_var::expand(const string& v)
 {
@@ -88,17 +309,15 @@ ODIF::env_var::expand(const string& v, bool r)
 string
 ODIF::env_var::expand(const string& v, bool r, const string& rm)
 {
-  string mn;
-
-  // remove prefix and suffix strings from named variable:
+  // lookup named variable without prefix and suffix strings:
   // example: "${" + VAR + "}" --> VAR
-  mn = v.substr( prefix.length()
-               , v.length()-(prefix.length()+suffix.length()) );
+  const size_t ei = find( v.data() + prefix.length()
+                        , v.length()-(prefix.length()+suffix.length()) );
 
   string rs;
 
-  if ( exists( mn ) ) {
-    rs = map[ mn ];
+  if ( ei != npos ) {
+    rs.assign( arena, entries[ ei ].val_off, entries[ ei ].val_len );
   } else {
     // avoid future expansion, use 'mn' rather than 'v'
     // if ( r ) rs = mn + "=" + rm;
@@ -201,8 +420,18 @@ ODIF::env_var::dump(void) {
   cout << endl
        << "(var map begin)" << endl;
 
-  for ( std::map<string, string>::iterator  it=map.begin();
-                                            it!=map.end();
+  // list in name order.
+  std::map<string, string> vm;
+
+  for ( vector<entry_s>::iterator it=entries.begin(); it!=entries.end(); ++it )
+  {
+    if ( it->live )
+      vm[ arena.substr(it->key_off, it->key_len) ]
+        = arena.substr(it->val_off, it->val_len);
+  }
+
+  for ( std::map<string, string>::iterator  it=vm.begin();
+                                            it!=vm.end();
                                           ++it )
   {
     cout << it->first << "=" << it->second << endl;
@@ -480,217 +709,2432 @@ ODIF::func_args::dump(void)
 
 
 ////////////////////////////////////////////////////////////////////////////////
-// UTIL
+// ODIF::opt_values
 ////////////////////////////////////////////////////////////////////////////////
 
-void
-UTIL::sys_command(
-  const string& command,
-        string& result,
-        bool& success,
-  const bool& standard_error,
-  const bool& replace_newlines)
+string
+ODIF::opt_values::str(const size_t i) const
 {
-  string cmd_str( command );
+  switch ( decl[i].type )
+  {
+    case opt_text:  return( UTIL::unquote( raw(i) ) );
+    case opt_trim:  return( UTIL::unquote_trim( raw(i) ) );
+    default:        return( raw(i) );
+  }
+}
 
-  if ( standard_error )
-    cmd_str.append(" 2>&1");
+int
+ODIF::opt_values::num(const size_t i) const
+{
+  return( atoi( UTIL::unquote_trim( raw(i) ).c_str() ) );
+}
 
-#ifdef HAVE_POPEN
-  FILE* pipe;
-  char buffer[128];
 
-  pipe = popen( cmd_str.c_str(), "r" );
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::opt_schema
+////////////////////////////////////////////////////////////////////////////////
 
-  if (!pipe)
-  {
-    result = "popen() failed for " + cmd_str;
+const size_t ODIF::opt_schema::npos;
 
-    success=false;
-  }
-  else
-  {
-    while ( !feof(pipe) )
-    {
-      if ( fgets(buffer, 128, pipe) != NULL )
-          result.append( buffer );
-    }
+void
+ODIF::opt_schema::init(const string& t)
+{
+  help_str = t + ": [";
 
-    pclose(pipe);
+  for ( size_t i=0; i < count; ++i )
+  {
+    if (i) help_str.append( ", " );
+    help_str.append( string(decl[i].name) + " (" + decl[i].sc + ")" );
 
-    success=true;
+    names.push_back( make_pair( string(decl[i].name), 2*i ) );
+    names.push_back( make_pair( string(decl[i].sc), 2*i+1 ) );
   }
-#else /* HAVE_POPEN */
-  result = "popen() not available, unable to execute " + cmd_str;
-
-  success=false;
-#endif /* HAVE_POPEN */
+  help_str.append( "]" );
 
-  if ( replace_newlines )
-    result = UTIL::replace_chars(result, "\n\r", ' ');
+  sort( names.begin(), names.end() );
 }
 
 size_t
-UTIL::get_indent(const std::string& t)
+ODIF::opt_schema::find(const string& n) const
 {
-  istringstream iss(t);
-  string line;
+  vector< pair<string, size_t> >::const_iterator
+    it = lower_bound( names.begin(), names.end(), make_pair(n, size_t(0)) );
 
-  // move to first non-empty line
-  while ( line.empty() && !iss.eof() )
-    getline(iss, line);
+  if ( it != names.end() && it->first == n )
+    return ( it->second / 2 );
 
-  return ( line.find_first_not_of( " \t" ) );
+  return ( npos );
 }
 
-string
-UTIL::indent_line(const string& l, const int n)
+bool
+ODIF::opt_schema::parse(const func_args& a, opt_values& v,
+                        const func_args::arg_term*& bad) const
 {
-  string new_line;
+  // first occurrence of each long name and short code, or the last
+  // occurrence of either (in lv).
+  vector<const string*> lv( count, static_cast<const string*>(NULL) );
+  vector<const string*> sv( count, static_cast<const string*>(NULL) );
 
-  for (int i=0; i<n; i++)
-    new_line.append( " " );
+  bad = NULL;
 
-  new_line.append( l );
+  for ( vector<func_args::arg_term>::const_iterator it=a.argv.begin();
+                                                    it!=a.argv.end();
+                                                  ++it )
+  {
+    if ( it->positional )
+    {
+      if ( (modes & named) && it != a.argv.begin() && bad == NULL )
+        bad = &(*it);
 
-  return new_line;
-}
+      continue;
+    }
 
-string
-UTIL::indent_text(const string& t, const int n)
-{
-  istringstream iss(t);
-  string new_text;
+    vector< pair<string, size_t> >::const_iterator
+      ni = lower_bound( names.begin(), names.end(), make_pair(it->name, size_t(0)) );
 
-  while ( !iss.eof() )
-  {
-    string line;
+    if ( ni == names.end() || ni->first != it->name )
+    {
+      if ( bad == NULL ) bad = &(*it);
+      continue;
+    }
 
-    getline(iss, line);
+    for ( ; ni != names.end() && ni->first == it->name; ++ni )
+    {
+      if ( modes & last )
+      {
+        lv[ ni->second / 2 ] = &it->value;
+        continue;
+      }
 
-    for (int i=0; i<n; i++)
-      new_text.append( " " );
+      vector<const string*>& fv = ( ni->second % 2 ) ? sv : lv;
 
-    new_text.append( line );
-    new_text.append( "\n" );
+      if ( fv[ ni->second / 2 ] == NULL )
+        fv[ ni->second / 2 ] = &it->value;
+    }
   }
 
-  return new_text;
+  v.decl = decl;
+  v.val.resize( count );
+  for ( size_t i=0; i < count; ++i )
+    v.val[i] = lv[i] ? lv[i] : sv[i];
+
+  return ( bad == NULL );
 }
 
-string
-UTIL::get_word(const string& w, const int n)
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::word_list
+////////////////////////////////////////////////////////////////////////////////
+
+void
+ODIF::word_list::assign(const char* t, const size_t n, const string& d,
+                        const bool s)
 {
-  istringstream iss(w);
-  string iw, rw;
+  text.assign( t, n );
+  ext = NULL;
+  len = n;
+  delim = d;
+  trim = s;
+  built = false;
+  clear_span();
+
+  const char* b = text.data();
+
+  // delimiter lookup table
+  bool dl[256] = { false };
+  for ( string::const_iterator it=d.begin(); it!=d.end(); ++it )
+    dl[ static_cast<unsigned char>(*it) ] = true;
+
+  size_t i = 0;
+  while ( i < n )
+  {
+    // skip delimiters
+    while ( i < n && dl[ static_cast<unsigned char>(b[i]) ] ) ++i;
 
-  for (int l=1; iss >> iw; l++)
-    if ( l==n ) {
-      rw=iw;
+    size_t f = i;
+    while ( i < n && !dl[ static_cast<unsigned char>(b[i]) ] ) ++i;
+
+    if ( i == f )                       // trailing delimiters
       break;
+
+    size_t l = i;
+
+    // a word of only white space trims to an empty word (kept)
+    if ( s )
+    {
+      while ( f < l && isspace( static_cast<unsigned char>(b[f]) ) ) ++f;
+      while ( l > f && isspace( static_cast<unsigned char>(b[l-1]) ) ) --l;
     }
 
-  return rw;
+    span->push_back( make_pair(f, l - f) );
+  }
 }
 
-size_t
-UTIL::word_count(const string& w)
+
+void
+ODIF::word_list::append(const string& w, const string& s)
 {
-  istringstream iss(w);
-  string iw;
+  if ( !built )
+  { // first word: start a built list
+    text.clear();
+    ext = NULL;
+    delim.clear();
+    trim = false;
+    clear_span();
+
+    built = true;
+    blank = padded = joined = false;
+    word_chars.reset();
+    sep_chars.reset();
+  }
 
-  size_t l = 0;
-  while( iss >> iw ) { l++; }
+  // positions shared with a copy are not changed.
+  if ( span.use_count() > 1 )
+    span = make_shared<span_type>( *span );
 
-  return l;
+  if ( s.empty() && !span->empty() )
+    joined = true;
+
+  for ( string::const_iterator it=s.begin(); it!=s.end(); ++it )
+    sep_chars.set( static_cast<unsigned char>(*it) );
+
+  for ( string::const_iterator it=w.begin(); it!=w.end(); ++it )
+    word_chars.set( static_cast<unsigned char>(*it) );
+
+  if ( w.empty() )
+    blank = true;
+  else if ( isspace( static_cast<unsigned char>(w[0]) ) ||
+            isspace( static_cast<unsigned char>(w[w.length()-1]) ) )
+    padded = true;
+
+  text.append( s );
+  span->push_back( make_pair(text.length(), w.length()) );
+  text.append( w );
+
+  len = text.length();
 }
 
 string
-UTIL::remove_chars(const string &s, const string &c)
+ODIF::word_list::release(void)
 {
-  return ( replace_chars(s, c, '\0') );
+  string t;
+  t.swap( text );
+
+  return( t );
 }
 
-string
-UTIL::replace_chars(const string &s, const string &c, const char r)
+void
+ODIF::word_list::bind(const word_list& l, const char* t)
 {
-  string result;
+  text.clear();
+  ext = t;
+  len = l.len;
+  delim = l.delim;
+  trim = l.trim;
+
+  built = l.built;
+  blank = l.blank;
+  padded = l.padded;
+  joined = l.joined;
+  word_chars = l.word_chars;
+  sep_chars = l.sep_chars;
+
+  span = l.span;
+}
 
-  for ( string::const_iterator its=s.begin(); its!=s.end(); ++its ) {
-    bool append = true;
+bool
+ODIF::word_list::splits_as(const string& d, const bool s) const
+{
+  if ( !built )
+    return( delim == d && trim == s );
 
-    for ( string::const_iterator itc=c.begin(); itc!=c.end(); ++itc )
-      if ( *its == *itc ) { append = false; break; }
+  // splitting drops empty words, joins words without a separator,
+  // and trimming changes words with outer white space.
+  if ( blank || joined || ( s && padded ) )
+    return( false );
 
-    if ( append )       result += *its;
-    else if (r != '\0') result += r;
-  }
+  // no word may contain a delimiter and each separator must be only
+  // delimiters.
+  bitset<256> dc;
+  for ( string::const_iterator it=d.begin(); it!=d.end(); ++it )
+    dc.set( static_cast<unsigned char>(*it) );
 
-  return( result );
+  return( (word_chars & dc).none() && (sep_chars & ~dc).none() );
 }
 
-string
-UTIL::unquote(const string &s)
-{
-  string r = s;
 
-  // remove outermost matching quotations
-  // (1) quotes must be outermost text, excluding whitespace
-  // (2) quotes must be matching set
-  // (3) leading and trailing whitespace before and after
-  //     the outermost quotation are discarded.
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::word_list_cache
+////////////////////////////////////////////////////////////////////////////////
 
-  // locate outer bounds of non-white space text
-  size_t fc = s.find_first_not_of(" \f\n\r\t\v");
-  size_t lc = s.find_last_not_of(" \f\n\r\t\v");
+size_t ODIF::word_list_cache::hit_count = 0;
 
-  // locate outermost quotations
-  size_t fq = s.find_first_of("\"\'");
-  size_t lq = s.find_last_of("\"\'");
+const ODIF::word_list&
+ODIF::word_list_cache::get(const char* t, const size_t n, const string& d,
+                           const bool s)
+{
+  // the last list is compared first, which is cheaper than hashing
+  if ( recent )
+  {
+    word_list* wl = lists.find( recent_h );
 
-  // unquote iff:
-  // (1) not one in the same (character or string::npos)
-  // (2) first non-white space character is first quote
-  // (3) last non-white space character is last quote
-  // (4) the quote characters are a matched pair
-  if ( (fq != lq) && (fc == fq) && (lc == lq) )
-  { // quotate character must match: ie '' or ""
-    if ( s.at(fq) == s.at(lq) )
+    if ( wl && wl->matches( t, n, d, s ) )
     {
-      if ( (lq-fq) < 2 )
-        // check for quoted null string ""
-        r.clear();
-      else
-        // copy string between quotes
-        r = s.substr( fq+1, lq-1-fq );
+      ++hit_count;
+      return( *wl );
     }
   }
 
-  return( r );
+  const uint64_t h = UTIL::hash_fnv1a( t, n, UTIL::hash_fnv1a( d ) ) ^ s;
+
+  recent = true;
+  recent_h = h;
+
+  word_list* wl = lists.find( h );
+
+  if ( wl && wl->matches( t, n, d, s ) )
+  {
+    ++hit_count;
+    return( *wl );
+  }
+
+  // new text (or a different text with the same hash: replaced)
+  if ( wl == NULL )
+    wl = &lists.insert( h, word_list() );
+
+  wl->assign( t, n, d, s );
+
+  return( *wl );
 }
 
-string
-UTIL::unquote_trim(const string &s)
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::char_class
+////////////////////////////////////////////////////////////////////////////////
+
+const size_t ODIF::char_class::list_max;
+
+void
+ODIF::char_class::clear(void)
 {
-  return ( boost::trim_copy( unquote( s ) ) );
+  std::fill( member, member + 256, false );
+  count = 0;
 }
 
-string
-UTIL::to_string(const long v)
+void
+ODIF::char_class::add(const string& c)
 {
-  ostringstream os;
+  for ( string::const_iterator it=c.begin(); it!=c.end(); ++it )
+  {
+    const unsigned char u = static_cast<unsigned char>( *it );
 
-  os << dec << v;
+    if ( member[u] ) continue;
 
-  return ( os.str() );
+    member[u] = true;
+    if ( count < list_max ) listed[count] = u;
+    ++count;
+  }
 }
 
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::line_view
+////////////////////////////////////////////////////////////////////////////////
+
 bool
-UTIL::is_number(const std::string& s)
+ODIF::line_view::next(void)
 {
-  string::const_iterator it = s.begin();
+  if ( done )
+    return( false );
 
-  while ( it != s.end() && isdigit(*it) )
+  const char* e = ( pos != end )
+                ? static_cast<const char*>( memchr(pos, '\n', end - pos) )
+                : NULL;
+
+  cur = pos;
+
+  if ( e != NULL )
+  {
+    len = e - pos;
+    pos = e + 1;
+  }
+  else
+  { // last line, without a newline
+    len = end - pos;
+    pos = end;
+    done = true;
+  }
+
+  return( true );
+}
+
+size_t
+ODIF::line_view::count(const char* d, const size_t n)
+{
+  size_t c = 1;
+
+  for ( const char* p = d; p != d + n && (p = static_cast<const char*>
+                                     (memchr(p, '\n', d + n - p))) != NULL; ++p )
+    ++c;
+
+  return( c );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::line_index
+////////////////////////////////////////////////////////////////////////////////
+
+const size_t ODIF::line_index::npos;
+
+void
+ODIF::line_index::assign(const char* d, const size_t n)
+{
+  data = d;
+  size = n;
+
+  start.clear();
+  start.push_back( 0 );
+
+  for ( const char* p = d; p && (p = static_cast<const char*>
+                                     (memchr(p, '\n', d + n - p))) != NULL; ++p )
+    start.push_back( p - d + 1 );
+
+  total = 0;
+  longest = 0;
+  shortest = npos;
+
+  for ( size_t i=0; i < start.size(); ++i )
+  {
+    size_t l = length( i );
+
+    total += l;
+    if ( l > longest ) longest = l;
+    if ( l && l < shortest ) shortest = l;
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::file_cache
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ODIF::file_cache::load_count = 0;
+size_t ODIF::file_cache::hit_count = 0;
+
+ODIF::file_cache::entry_s::~entry_s(void)
+{
+#if defined(HAVE_MMAP)
+  if ( addr != NULL )
+    munmap( addr, size );
+#endif
+}
+
+shared_ptr<const ODIF::line_index>
+ODIF::file_cache::share(const string& f)
+{
+  struct stat st;
+
+  if ( stat( f.c_str(), &st ) != 0 || !S_ISREG( st.st_mode ) )
+    return ( shared_ptr<const line_index>() );
+
+  uintmax_t z = st.st_size;
+  time_t m = st.st_mtime;
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+  long n = st.st_mtim.tv_nsec;
+#else
+  long n = 0;
+#endif
+
+  shared_ptr<entry_s>& e = entries[ f ];
+
+  if ( e && e->size == z && e->mtime == m && e->mtime_ns == n )
+  {
+    ++hit_count;
+    return ( shared_ptr<const line_index>( e, &e->index ) );
+  }
+
+  // new entry; holders of a previous one keep it until released
+  shared_ptr<entry_s> ne = make_shared<entry_s>();
+
+  ne->size = z;
+  ne->mtime = m;
+  ne->mtime_ns = n;
+
+  bool loaded = false;
+
+#if defined(HAVE_MMAP)
+  if ( z > 0 )
+  {
+    int fd = open( f.c_str(), O_RDONLY );
+
+    if ( fd >= 0 )
+    {
+      void* a = mmap( NULL, z, PROT_READ, MAP_PRIVATE, fd, 0 );
+      close( fd );
+
+      if ( a != MAP_FAILED )
+      {
+        ne->addr = a;
+        ne->index.assign( static_cast<const char*>(a), z );
+        loaded = true;
+      }
+    }
+  }
+#endif
+
+  if ( !loaded )
+  { // read a copy
+    ifstream ifs( f.c_str(), ios::binary );
+
+    if ( !ifs.is_open() )
+    {
+      entries.erase( f );
+      return ( shared_ptr<const line_index>() );
+    }
+
+    ne->copy.assign( (istreambuf_iterator<char>( ifs )), istreambuf_iterator<char>() );
+    ne->index.assign( ne->copy.data(), ne->copy.size() );
+  }
+
+  ++load_count;
+
+  e = ne;
+
+  return ( shared_ptr<const line_index>( e, &e->index ) );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::output_sink
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ODIF::output_sink::write_count = 0;
+
+ODIF::output_sink::output_sink(const size_t c)
+  : cap(c), fd(STDOUT_FILENO), own(false), failed(false)
+{
+  buf.reserve( cap );
+}
+
+ODIF::output_sink::~output_sink(void)
+{
+  flush();
+
+  if ( own )
+    close( fd );
+}
+
+bool
+ODIF::output_sink::open(const string& f)
+{
+  int n = ::open( f.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0666 );
+
+  if ( n < 0 )
+    return ( false );
+
+  flush();
+
+  if ( own )
+    close( fd );
+
+  fd = n;
+  own = true;
+
+  return ( true );
+}
+
+bool
+ODIF::output_sink::write_fd(const char* b, size_t n)
+{
+  if ( failed )
+    return ( false );
+
+  while ( n > 0 )
+  {
+    ssize_t w = ::write( fd, b, n );
+    ++write_count;
+
+    if ( w < 0 )
+    {
+      if ( errno == EINTR ) continue;
+
+      failed = true;
+      return ( false );
+    }
+
+    b += w;
+    n -= w;
+  }
+
+  return ( true );
+}
+
+ODIF::output_sink::int_type
+ODIF::output_sink::overflow(int_type c)
+{
+  if ( !traits_type::eq_int_type( c, traits_type::eof() ) )
+  {
+    char ch = traits_type::to_char_type( c );
+    write( &ch, 1 );
+  }
+
+  // a failed write sets the stream badbit
+  if ( failed )
+    return ( traits_type::eof() );
+
+  return ( traits_type::not_eof( c ) );
+}
+
+streamsize
+ODIF::output_sink::xsputn(const char* s, streamsize n)
+{
+  write( s, n );
+
+  return ( failed ? 0 : n );
+}
+
+int
+ODIF::output_sink::sync(void)
+{
+  return ( flush() ? 0 : -1 );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::coprocess
+////////////////////////////////////////////////////////////////////////////////
+
+#if defined(HAVE_FORK) && defined(HAVE_PIPE)
+int
+UTIL::pipe_cloexec(int fd[2])
+{
+#if defined(HAVE_PIPE2)
+  return ( pipe2(fd, O_CLOEXEC) );
+#else
+  // not atomic: a concurrent fork may inherit the descriptors.
+  if ( pipe(fd) != 0 )
+    return ( -1 );
+
+  fcntl(fd[0], F_SETFD, FD_CLOEXEC);
+  fcntl(fd[1], F_SETFD, FD_CLOEXEC);
+
+  return ( 0 );
+#endif
+}
+#endif
+
+bool
+ODIF::coprocess::start(const string& p, const string& a)
+{
+  stop();
+
+#if defined(HAVE_FORK) && defined(HAVE_PIPE)
+  int to_child[2];
+  int from_child[2];
+
+  if ( UTIL::pipe_cloexec(to_child) != 0 )
+    return ( false );
+
+  if ( UTIL::pipe_cloexec(from_child) != 0 )
+  {
+    close(to_child[0]); close(to_child[1]);
+    return ( false );
+  }
+
+  pid_t cp = fork();
+
+  if ( cp < 0 )
+  {
+    close(to_child[0]); close(to_child[1]);
+    close(from_child[0]); close(from_child[1]);
+    return ( false );
+  }
+
+  if ( cp == 0 )
+  { // child: default SIGPIPE handling (see write_all()).
+    sigset_t ss;
+    sigemptyset(&ss);
+    sigaddset(&ss, SIGPIPE);
+    pthread_sigmask(SIG_UNBLOCK, &ss, NULL);
+    signal(SIGPIPE, SIG_DFL);
+
+    // connect pipes to standard input and output.
+    dup2(to_child[0], STDIN_FILENO);
+    dup2(from_child[1], STDOUT_FILENO);
+
+    close(to_child[0]); close(to_child[1]);
+    close(from_child[0]); close(from_child[1]);
+
+    execl(p.c_str(), p.c_str(), a.c_str(), static_cast<char*>(NULL));
+    _exit(127);
+  }
+
+  close(to_child[0]);
+  close(from_child[1]);
+
+  pid = cp;
+  wfd = to_child[1];
+  rfd = from_child[0];
+
+  return ( true );
+#else
+  (void)p; (void)a;
+
+  return ( false );
+#endif
+}
+
+void
+ODIF::coprocess::stop(void)
+{
+#if defined(HAVE_FORK) && defined(HAVE_PIPE)
+  if ( wfd >= 0 ) close(wfd);
+  if ( rfd >= 0 ) close(rfd);
+
+  if ( pid > 0 )
+  {
+    // a program that did not respond may not read its end of file.
+    if ( expired )
+      kill(pid, SIGKILL);
+
+    int status;
+    waitpid(pid, &status, 0);
+  }
+#endif
+
+  pid = wfd = rfd = -1;
+}
+
+bool
+ODIF::coprocess::write_all(const char* b, size_t n)
+{
+#if defined(HAVE_FORK) && defined(HAVE_PIPE)
+  // a terminated program must not terminate the filter on write:
+  // block SIGPIPE for this thread only, and consume any it raises.
+  sigset_t ps, ss, os;
+  sigemptyset(&ss);
+  sigaddset(&ss, SIGPIPE);
+
+  sigpending(&ps);
+  const bool pending = sigismember(&ps, SIGPIPE);
+
+  pthread_sigmask(SIG_BLOCK, &ss, &os);
+
+  bool good = true;
+  while ( n > 0 )
+  {
+    ssize_t c = write(wfd, b, n);
+
+    if ( c < 0 && errno == EINTR ) continue;
+    if ( c <= 0 ) { good = false; break; }
+
+    b += c;
+    n -= c;
+  }
+
+  if ( !good && !pending )
+  {
+    int sig;
+
+    sigpending(&ps);
+    if ( sigismember(&ps, SIGPIPE) )
+      sigwait(&ss, &sig);
+  }
+
+  pthread_sigmask(SIG_SETMASK, &os, NULL);
+
+  return ( good );
+#else
+  (void)b; (void)n;
+
+  return ( false );
+#endif
+}
+
+bool
+ODIF::coprocess::read_all(char* b, size_t n)
+{
+#if defined(HAVE_FORK) && defined(HAVE_PIPE)
+  while ( n > 0 )
+  {
+#if defined(HAVE_POLL)
+    if ( deadline )
+    { // wait for output within the response deadline
+      int64_t left = deadline - chrono::duration_cast<chrono::milliseconds>
+                     ( chrono::steady_clock::now().time_since_epoch() ).count();
+
+      struct pollfd pfd = { rfd, POLLIN, 0 };
+      int p = ( left > 0 ) ? poll(&pfd, 1, static_cast<int>(left)) : 0;
+
+      if ( p < 0 && errno == EINTR ) continue;
+      if ( p == 0 ) { expired = true; return ( false ); }
+      if ( p < 0 ) return ( false );
+    }
+#endif
+
+    ssize_t c = read(rfd, b, n);
+
+    if ( c < 0 && errno == EINTR ) continue;
+    if ( c <= 0 ) return ( false );
+
+    b += c;
+    n -= c;
+  }
+
+  return ( true );
+#else
+  (void)b; (void)n;
+
+  return ( false );
+#endif
+}
+
+bool
+ODIF::coprocess::read_line(string& l)
+{
+  char c;
+
+  l.clear();
+  while ( read_all(&c, 1) )
+  {
+    if ( c == '\n' )
+      return ( true );
+
+    l += c;
+  }
+
+  return ( false );
+}
+
+bool
+ODIF::coprocess::request(const string& q, string& r, int& s)
+{
+  r.clear();
+  expired = false;
+
+  if ( !running() )
+    return ( false );
+
+  deadline = timeout ? chrono::duration_cast<chrono::milliseconds>
+                       ( chrono::steady_clock::now().time_since_epoch() ).count()
+                     + int64_t(timeout) * 1000 : 0;
+
+  // request: "<length>\n<text>"
+  string h = UTIL::to_string( q.length() ) + "\n";
+
+  if ( !write_all(h.data(), h.length()) || !write_all(q.data(), q.length()) )
+  {
+    stop();
+    return ( false );
+  }
+
+  // response: "<status> <length>\n<text>"
+  string l;
+  long rl = -1;
+
+  if ( !read_line(l) || sscanf(l.c_str(), "%d %ld", &s, &rl) != 2 || rl < 0 )
+  {
+    stop();
+    return ( false );
+  }
+
+  r.resize( rl );
+  if ( rl > 0 && !read_all(&r[0], rl) )
+  {
+    stop();
+    return ( false );
+  }
+
+  return ( true );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::command_pool
+////////////////////////////////////////////////////////////////////////////////
+
+ODIF::command_pool::~command_pool(void)
+{
+  {
+    std::unique_lock<std::mutex> l( lock );
+    stopping = true;
+  }
+  queued.notify_all();
+
+  for ( vector<std::thread>::iterator it=workers.begin(); it!=workers.end(); ++it )
+    it->join();
+}
+
+size_t
+ODIF::command_pool::submit(const string& c, const bool se, const bool rn,
+                           const UTIL::proc_limits& pl)
+{
+  std::unique_lock<std::mutex> l( lock );
+
+  job_s j = { c, se, rn, pl, "", false, false, false };
+
+  size_t id = next_id + records.size();
+
+  records.push_back( j );
+  pending.push_back( id );
+
+  // start workers as needed, up to the job limit.
+  if ( workers.size() < jobs )
+    workers.push_back( std::thread(&ODIF::command_pool::work, this) );
+
+  queued.notify_one();
+
+  return ( id );
+}
+
+bool
+ODIF::command_pool::done(const size_t i)
+{
+  std::unique_lock<std::mutex> l( lock );
+
+  return ( i < next_id || records[ i - next_id ].done );
+}
+
+void
+ODIF::command_pool::wait(const size_t i, string& r, bool& s)
+{
+  std::unique_lock<std::mutex> l( lock );
+
+  job_s& j = records[ i - next_id ];
+
+  while ( !j.done )
+    finished.wait( l );
+
+  r.swap( j.result );
+  s = j.good;
+
+  // release records that have been collected (in identifier order).
+  j.taken = true;
+  while ( !records.empty() && records.front().taken )
+  {
+    records.pop_front();
+    ++next_id;
+  }
+}
+
+void
+ODIF::command_pool::work(void)
+{
+  std::unique_lock<std::mutex> l( lock );
+
+  while ( true )
+  {
+    while ( pending.empty() && !stopping )
+      queued.wait( l );
+
+    if ( pending.empty() )
+      return;
+
+    size_t id = pending.front();
+    pending.pop_front();
+
+    // deque references remain valid as records are only appended or
+    // released after completion.
+    job_s& j = records[ id - next_id ];
+
+    string c = j.command;
+    bool se = j.std_err;
+    bool rn = j.rm_nl;
+    UTIL::proc_limits pl = j.limits;
+
+    string r;
+    bool s = false;
+
+    l.unlock();
+    UTIL::sys_command( c, r, s, se, rn, pl );
+    l.lock();
+
+    job_s& jd = records[ id - next_id ];
+    jd.result.swap( r );
+    jd.good = s;
+    jd.done = true;
+
+    finished.notify_all();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::result_cache
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ODIF::result_cache::hit_count = 0;
+size_t ODIF::result_cache::miss_count = 0;
+size_t ODIF::result_cache::put_count = 0;
+
+/*
+  entry file format:
+
+    <key-length>\n<key><status> <output-length>\n<output>
+
+  the complete key is stored and compared on lookup so that a hash
+  collision can never return the result of a different command.
+*/
+
+string
+ODIF::result_cache::entry(const string& k) const
+{
+  ostringstream os;
+  os << hex << setfill('0') << setw(16) << UTIL::hash_fnv1a( k );
+
+  return ( ( boost::filesystem::path( path ) / os.str() ).string() );
+}
+
+bool
+ODIF::result_cache::get(const string& k, string& r, bool& s)
+{
+  ifstream ifs( entry( k ).c_str(), ios::binary );
+
+  size_t kl = 0, rl = 0;
+  int st = 0;
+
+  if ( ifs.good() && (ifs >> kl) && ifs.get() == '\n' && kl == k.length() )
+  {
+    string ek( kl, '\0' );
+
+    if ( ifs.read( &ek[0], kl ) && ek == k &&
+         (ifs >> st >> rl) && ifs.get() == '\n' )
+    {
+      string er( rl, '\0' );
+
+      if ( rl == 0 || ifs.read( &er[0], rl ) )
+      {
+        r.swap( er );
+        s = ( st == 0 );
+
+        ++hit_count;
+        return ( true );
+      }
+    }
+  }
+
+  ++miss_count;
+  return ( false );
+}
+
+bool
+ODIF::result_cache::put(const string& k, const string& r, const bool s)
+{
+  if ( !enabled() )
+    return ( false );
+
+  boost::system::error_code ec;
+  boost::filesystem::create_directories( path, ec );
+
+  // write to a unique name and rename to replace the entry atomically.
+  string e = entry( k );
+  string t = e + boost::filesystem::unique_path( ".%%%%-%%%%" ).string();
+
+  ofstream ofs( t.c_str(), ios::binary );
+  if ( !ofs.is_open() )
+    return ( false );
+
+  ofs << k.length() << '\n' << k
+      << ( s ? 0 : 1 ) << ' ' << r.length() << '\n' << r;
+  ofs.close();
+
+  if ( !ofs )
+  {
+    boost::filesystem::remove( t, ec );
+    return ( false );
+  }
+
+  boost::filesystem::rename( t, e, ec );
+  if ( ec )
+  {
+    boost::filesystem::remove( t, ec );
+    return ( false );
+  }
+
+  ++put_count;
+  return ( true );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::dir_index
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ODIF::dir_index::test_count = 0;
+size_t ODIF::dir_index::list_count = 0;
+size_t ODIF::dir_index::avoid_count = 0;
+
+void
+ODIF::dir_index::list(const string& d, dir_s& l)
+{
+  // a missing directory lists as empty.
+  boost::system::error_code ec;
+
+  l.names.clear();
+  l.mtime = boost::filesystem::last_write_time( d, ec );
+  if ( ec ) l.mtime = static_cast<time_t>(-1);
+
+  // a change later in the same second would not change the time.
+  l.racy = ( l.mtime >= time( NULL ) );
+
+  boost::filesystem::directory_iterator dit( d, ec ), end;
+
+  for ( ; !ec && dit != end; dit.increment( ec ) )
+    l.names.insert( dit->path().filename().string() );
+
+  ++list_count;
+}
+
+bool
+ODIF::dir_index::is_file(const boost::filesystem::path& p)
+{
+  ++test_count;
+
+  string d = p.parent_path().string();
+  if ( d.empty() ) d = ".";
+
+  map<string, dir_s>::iterator it = dirs.find( d );
+
+  if ( it == dirs.end() )
+  {
+    // list directory once.
+    it = dirs.insert( make_pair(d, dir_s()) ).first;
+
+    list( d, it->second );
+  }
+  else if ( it->second.epoch != epoch )
+  {
+    // list again when changed since listed.
+    boost::system::error_code ec;
+    time_t t = boost::filesystem::last_write_time( d, ec );
+    if ( ec ) t = static_cast<time_t>(-1);
+
+    if ( it->second.racy || t != it->second.mtime )
+      list( d, it->second );
+  }
+
+  it->second.epoch = epoch;
+
+  if ( it->second.names.find( p.filename().string() ) == it->second.names.end() )
+  {
+    ++avoid_count;
+    return ( false );
+  }
+
+  // listed: confirm type (may be a directory or a broken link).
+  boost::system::error_code ec;
+  return ( boost::filesystem::is_regular_file( p, ec ) );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::copy_manifest
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ODIF::copy_manifest::copy_count = 0;
+size_t ODIF::copy_manifest::skip_count = 0;
+
+/*
+  manifest format, one line per copy (last entry for a target wins):
+
+    <target>\t<source>\t<source-size>\t<source-mtime>\t<method>\n
+
+  the file is rewritten with one line per target once the replaced
+  lines outnumber the current ones.
+*/
+
+void
+ODIF::copy_manifest::load(void)
+{
+  loaded = true;
+  lines = 0;
+
+  ifstream ifs( path.c_str() );
+  string line;
+
+  while ( getline(ifs, line) )
+  {
+    vector<string> f = UTIL::string_tokenize_to_vector
+                       ( line, "\t", "", boost::keep_empty_tokens );
+
+    if ( f.size() != 5 )
+      continue;
+
+    entry_s e = { f[1], static_cast<uintmax_t>(strtoull(f[2].c_str(), NULL, 10)),
+                        static_cast<time_t>(strtoll(f[3].c_str(), NULL, 10)), f[4] };
+    entries[ f[0] ] = e;
+    ++lines;
+  }
+}
+
+void
+ODIF::copy_manifest::compact(void)
+{
+  namespace bfs = boost::filesystem;
+  boost::system::error_code ec;
+
+  // reread to keep the lines appended by concurrent filters.
+  entries.clear();
+  load();
+
+  // write to a unique name and rename to replace the manifest atomically.
+  string w = path + bfs::unique_path( ".%%%%-%%%%.tmp" ).string();
+
+  ofstream ofs( w.c_str() );
+  if ( !ofs.is_open() )
+    return;
+
+  for ( map<string, entry_s>::const_iterator it=entries.begin(); it!=entries.end(); ++it )
+    ofs << it->first << '\t' << it->second.source << '\t' << it->second.size << '\t'
+        << static_cast<long long>(it->second.mtime) << '\t' << it->second.method << '\n';
+  ofs.close();
+
+  if ( ofs )
+    bfs::rename( w, path, ec );
+
+  if ( !ofs || ec )
+    bfs::remove( w, ec );
+  else
+    lines = entries.size();
+}
+
+bool
+ODIF::copy_manifest::current(const string& s, const string& t, const bool h)
+{
+  namespace bfs = boost::filesystem;
+  boost::system::error_code ec;
+
+  if ( !loaded && enabled() )
+    load();
+
+  if ( !bfs::is_regular_file( t, ec ) )
+    return ( false );
+
+  uintmax_t ss = bfs::file_size( s, ec );
+  if ( ec ) return ( false );
+  time_t sm = bfs::last_write_time( s, ec );
+  if ( ec ) return ( false );
+
+  uintmax_t ts = bfs::file_size( t, ec );
+  if ( ec || ts != ss ) return ( false );
+
+  bool c = false;
+
+  map<string, entry_s>::const_iterator it = entries.find( t );
+
+  if ( bfs::equivalent( s, t, ec ) )
+    c = true;                                   // hard or symbolic link
+  else if ( it != entries.end() )
+    c = ( it->second.source == s && it->second.size == ss
+                                 && it->second.mtime == sm );
+  else
+    c = ( bfs::last_write_time( t, ec ) >= sm );  // not recorded
+
+  // optionally confirm differing metadata by content
+  if ( !c && h )
+    c = ( UTIL::hash_file( s ) == UTIL::hash_file( t ) );
+
+  if ( c ) ++skip_count;
+
+  return ( c );
+}
+
+void
+ODIF::copy_manifest::record(const string& s, const string& t, const string& m)
+{
+  namespace bfs = boost::filesystem;
+  boost::system::error_code ec;
+
+  ++copy_count;
+
+  if ( !enabled() )
+    return;
+
+  if ( !loaded )
+    load();
+
+  entry_s e = { s, bfs::file_size( s, ec ), bfs::last_write_time( s, ec ), m };
+  entries[ t ] = e;
+
+  // append a single line (concurrent filters each append whole lines)
+  ofstream ofs( path.c_str(), ios::app );
+  if ( ofs.is_open() )
+  {
+    ostringstream os;
+    os << t << '\t' << s << '\t' << e.size << '\t'
+       << static_cast<long long>(e.mtime) << '\t' << m << '\n';
+
+    ofs << os.str() << flush;
+    ++lines;
+  }
+  ofs.close();
+
+  if ( lines > 2 * entries.size() )
+    compact();
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::copy_queue
+////////////////////////////////////////////////////////////////////////////////
+
+ODIF::copy_queue::~copy_queue(void)
+{
+  {
+    std::unique_lock<std::mutex> l( lock );
+    stopping = true;
+  }
+  queued.notify_all();
+
+  for ( vector<std::thread>::iterator it=workers.begin(); it!=workers.end(); ++it )
+    it->join();
+}
+
+bool
+ODIF::copy_queue::submit(const string& s, const string& t,
+                         const UTIL::copy_policy p)
+{
+  copy_s c = { s, t, p, false, "" };
+
+  if ( threads == 0 )
+  { // copy now
+    if ( !targets.insert( t ).second )
+      return ( false );
+
+    run( c );
+    complete.push_back( c );
+
+    return ( true );
+  }
+
+  std::unique_lock<std::mutex> l( lock );
+
+  // one copy per target
+  if ( !targets.insert( t ).second )
+    return ( false );
+
+  pending.push_back( c );
+
+  if ( workers.size() < threads )
+    workers.push_back( std::thread(&ODIF::copy_queue::work, this) );
+
+  queued.notify_one();
+
+  return ( true );
+}
+
+void
+ODIF::copy_queue::drain(vector<copy_s>& r)
+{
+  std::unique_lock<std::mutex> l( lock );
+
+  while ( !pending.empty() || active != 0 )
+    finished.wait( l );
+
+  r.insert( r.end(), complete.begin(), complete.end() );
+  complete.clear();
+
+  // completed targets may be copied again (source could change).
+  targets.clear();
+}
+
+void
+ODIF::copy_queue::run(copy_s& c)
+{
+  // no lock: copy_asset() builds each target at a unique name and renames
+  // it into place, so concurrent copies (by these threads or by other
+  // filter processes) of one target leave a complete file.
+  UTIL::copy_policy u;
+  c.good = UTIL::copy_asset( c.source, c.target, c.policy, u, c.message );
+}
+
+void
+ODIF::copy_queue::work(void)
+{
+  std::unique_lock<std::mutex> l( lock );
+
+  while ( true )
+  {
+    while ( pending.empty() && !stopping )
+      queued.wait( l );
+
+    if ( pending.empty() )
+      return;
+
+    copy_s c = pending.front();
+    pending.pop_front();
+    ++active;
+
+    l.unlock();
+    run( c );
+    l.lock();
+
+    complete.push_back( c );
+    --active;
+
+    finished.notify_all();
+  }
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::config_snapshot
+////////////////////////////////////////////////////////////////////////////////
+
+size_t ODIF::config_snapshot::hit_count = 0;
+size_t ODIF::config_snapshot::miss_count = 0;
+
+/*
+  snapshot file format: a header line followed by entry records of
+  fields, each written as <length>\n<bytes>\n so that any text may be
+  stored. A later record of a key replaces an earlier one.
+
+    amu-config-snapshot 2
+    <key> <text> <n> <paths>... <n> <checks>...
+    ...
+*/
+
+namespace {
+
+  void
+  write_field(ostream& os, const string& s)
+  {
+    os << s.length() << '\n' << s << '\n';
+  }
+
+  void
+  write_fields(ostream& os, const vector<string>& v)
+  {
+    os << v.size() << '\n';
+    for ( vector<string>::const_iterator it=v.begin(); it!=v.end(); ++it )
+      write_field( os, *it );
+  }
+
+  bool
+  read_field(istream& is, string& s)
+  {
+    size_t l = 0;
+
+    if ( !(is >> l) || is.get() != '\n' )
+      return ( false );
+
+    s.resize( l );
+    if ( l && !is.read( &s[0], l ) )
+      return ( false );
+
+    return ( is.get() == '\n' );
+  }
+
+  bool
+  read_fields(istream& is, vector<string>& v)
+  {
+    size_t n = 0;
+
+    if ( !(is >> n) || is.get() != '\n' )
+      return ( false );
+
+    v.resize( n );
+    for ( size_t i=0; i < n; ++i )
+      if ( !read_field( is, v[i] ) )
+        return ( false );
+
+    return ( true );
+  }
+
+  const char* snapshot_header = "amu-config-snapshot 2";
+
+  void
+  write_record(ostream& os, const string& k,
+               const ODIF::config_snapshot::entry_s& e)
+  {
+    write_field( os, k );
+    write_field( os, e.text );
+    write_fields( os, e.paths );
+    write_fields( os, e.checks );
+  }
+
+}
+
+string
+ODIF::config_snapshot::state(const string& p)
+{
+  struct stat st;
+
+  if ( stat( p.c_str(), &st ) != 0 )
+    return ( "-" );
+
+  if ( S_ISDIR( st.st_mode ) )
+    return ( "d" );
+
+  ostringstream os;
+  os << st.st_size << ":" << st.st_mtime;
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+  os << "." << st.st_mtim.tv_nsec;
+#endif
+
+  return ( os.str() );
+}
+
+bool
+ODIF::config_snapshot::load(void)
+{
+  loaded = true;
+  records = 0;
+  entries.clear();
+
+  ifstream ifs( path.c_str(), ios::binary );
+  string h;
+
+  if ( !getline( ifs, h ) || h != snapshot_header )
+    return ( false );
+
+  while ( ifs.peek() != EOF )
+  {
+    string k;
+    entry_s e;
+
+    if ( !read_field( ifs, k ) || !read_field( ifs, e.text )
+      || !read_fields( ifs, e.paths ) || !read_fields( ifs, e.checks ) )
+      break;
+
+    entries[ k ] = e;
+    ++records;
+  }
+
+  return ( true );
+}
+
+bool
+ODIF::config_snapshot::get(const string& k, entry_s& e)
+{
+  if ( !enabled() )
+    return ( false );
+
+  if ( !loaded )
+    load();
+
+  map<string, entry_s>::const_iterator it = entries.find( k );
+
+  bool valid = ( it != entries.end() );
+
+  // each input must be in its recorded state
+  if ( valid )
+  {
+    const vector<string>& c = it->second.checks;
+
+    for ( vector<string>::const_iterator cit=c.begin(); valid && cit!=c.end(); ++cit )
+    {
+      size_t s = cit->find( ' ' );
+
+      valid = ( s != string::npos && state( cit->substr( s+1 ) ) == cit->substr( 0, s ) );
+    }
+  }
+
+  if ( !valid )
+  {
+    ++miss_count;
+    return ( false );
+  }
+
+  e = it->second;
+  ++hit_count;
+
+  return ( true );
+}
+
+void
+ODIF::config_snapshot::put(const string& k, const entry_s& e)
+{
+  if ( !enabled() )
+    return;
+
+  entries[ k ] = e;
+  pending.push_back( record_t( k, e ) );
+}
+
+bool
+ODIF::config_snapshot::flush(void)
+{
+  if ( !enabled() || pending.empty() )
+    return ( true );
+
+#if defined(HAVE_FLOCK)
+  // serialize with other runs that update the snapshot
+  string lf = path + ".lock";
+  int fd = open( lf.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0666 );
+  if ( fd >= 0 ) flock( fd, LOCK_EX );
+#endif
+
+  // include the records written by other runs since loading
+  vector<record_t> p;
+  p.swap( pending );
+
+  const bool current = load();
+
+  for ( vector<record_t>::const_iterator it=p.begin(); it!=p.end(); ++it )
+    entries[ it->first ] = it->second;
+
+  bool good;
+
+  if ( !current || records + p.size() > 2 * entries.size() )
+  { // (re)write with the current entries only
+    string tmp = path + "." + UTIL::to_string( getpid() ) + ".tmp";
+    ofstream ofs( tmp.c_str(), ios::binary | ios::trunc );
+
+    ofs << snapshot_header << '\n';
+
+    for ( map<string, entry_s>::const_iterator it=entries.begin(); it!=entries.end(); ++it )
+      write_record( ofs, it->first, it->second );
+
+    ofs.close();
+
+    good = ofs && rename( tmp.c_str(), path.c_str() ) == 0;
+
+    if ( good )
+      records = entries.size();
+    else
+      remove( tmp.c_str() );
+  }
+  else
+  { // append the new records
+    ofstream ofs( path.c_str(), ios::binary | ios::app );
+
+    for ( vector<record_t>::const_iterator it=p.begin(); it!=p.end(); ++it )
+      write_record( ofs, it->first, it->second );
+
+    ofs.close();
+
+    good = !ofs.fail();
+
+    if ( good )
+      records += p.size();
+  }
+
+#if defined(HAVE_FLOCK)
+  if ( fd >= 0 ) { flock( fd, LOCK_UN ); close( fd ); }
+#endif
+
+  return ( good );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// ODIF::profiler
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+  // return s quoted as a json string.
+  string
+  json_string(const string& s)
+  {
+    string r = "\"";
+
+    for ( string::const_iterator it=s.begin(); it!=s.end(); ++it )
+    {
+      unsigned char c = *it;
+
+      if      ( c == '"' )  r += "\\\"";
+      else if ( c == '\\' ) r += "\\\\";
+      else if ( c == '\n' ) r += "\\n";
+      else if ( c == '\t' ) r += "\\t";
+      else if ( c < 0x20 )
+      {
+        ostringstream os;
+        os << "\\u" << hex << setfill('0') << setw(4) << int(c);
+        r += os.str();
+      }
+      else
+        r += c;
+    }
+
+    return ( r + "\"" );
+  }
+
+  // return microseconds since the epoch of clock C.
+  template <typename C>
+  uint64_t
+  clock_us(void)
+  {
+    return ( chrono::duration_cast<chrono::microseconds>
+             ( C::now().time_since_epoch() ).count() );
+  }
+
+}
+
+uint64_t
+ODIF::profiler::child_time(void)
+{
+#if defined(HAVE_GETRUSAGE)
+  struct rusage ru;
+
+  if ( getrusage( RUSAGE_CHILDREN, &ru ) == 0 )
+    return ( uint64_t(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) * 1000000
+             + ru.ru_utime.tv_usec + ru.ru_stime.tv_usec );
+#endif
+
+  return ( 0 );
+}
+
+ODIF::profiler::mark_s
+ODIF::profiler::begin(const size_t h) const
+{
+  mark_s m = { clock_us<chrono::system_clock>(),
+               clock_us<chrono::steady_clock>(), child_time(), h };
+
+  return ( m );
+}
+
+void
+ODIF::profiler::end(const mark_s& m, const string& n,
+                    const string& f, const size_t l,
+                    const size_t b, const size_t h)
+{
+  event_s e = { n, f, l, m.ts,
+                clock_us<chrono::steady_clock>() - m.t0,
+                child_time() - m.child,
+                b, h - m.hits };
+
+  events.push_back( e );
+}
+
+string
+ODIF::profiler::trace_path(const string& p) const
+{
+  // a directory: one trace per run named for the process and its id
+  if ( *path.rbegin() == '/' || boost::filesystem::is_directory( path ) )
+    return ( ( boost::filesystem::path( path )
+               / ( UTIL::replace_chars( p, "/\\", '_' ) + "."
+                   + UTIL::to_string( getpid() ) + ".json" ) ).string() );
+
+  string r;
+
+  for ( size_t i=0; i < path.length(); ++i )
+  {
+    if ( path[i] != '%' || i+1 == path.length() )
+    {
+      r += path[i];
+      continue;
+    }
+
+    switch ( path[++i] )
+    {
+      case 'p': r += UTIL::to_string( getpid() ); break;
+      case 'f': r += UTIL::replace_chars( p, "/\\", '_' ); break;
+      case '%': r += '%'; break;
+      default : r += '%'; r += path[i]; break;
+    }
+  }
+
+  return ( r );
+}
+
+bool
+ODIF::profiler::write(const string& p) const
+{
+  if ( !enabled() )
+    return ( false );
+
+  ofstream ofs( trace_path( p ).c_str(), ios::trunc );
+
+  if ( !ofs.is_open() )
+    return ( false );
+
+  const int pid = getpid();
+
+  // trace event format (json object); one process per filter run
+  ofs << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" << endl
+      << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+      << ",\"tid\":0,\"args\":{\"name\":" << json_string( p ) << "}}";
+
+  for ( vector<event_s>::const_iterator it=events.begin(); it!=events.end(); ++it )
+  {
+    ofs << "," << endl
+        << "{\"name\":" << json_string( it->name )
+        << ",\"cat\":\"amu\",\"ph\":\"X\",\"pid\":" << pid << ",\"tid\":0"
+        << ",\"ts\":" << it->ts << ",\"dur\":" << it->dur
+        << ",\"args\":{\"file\":" << json_string( it->file )
+        << ",\"line\":" << it->line
+        << ",\"child_us\":" << it->child
+        << ",\"bytes\":" << it->bytes
+        << ",\"cache_hits\":" << it->hits << "}}";
+  }
+
+  ofs << endl << "]}" << endl;
+
+  return ( ofs.good() );
+}
+
+void
+ODIF::profiler::summary(ostream& os, const size_t c) const
+{
+  struct total_s { string name; size_t calls; uint64_t dur, child; size_t bytes, hits; };
+
+  map<string, total_s> tm;
+
+  for ( vector<event_s>::const_iterator it=events.begin(); it!=events.end(); ++it )
+  {
+    total_s& t = tm[ it->name ];
+
+    if ( t.name.empty() )
+    {
+      total_s z = { it->name, 0, 0, 0, 0, 0 };
+      t = z;
+    }
+
+    t.calls++;
+    t.dur += it->dur;
+    t.child += it->child;
+    t.bytes += it->bytes;
+    t.hits += it->hits;
+  }
+
+  vector<total_s> tv;
+  for ( map<string, total_s>::const_iterator it=tm.begin(); it!=tm.end(); ++it )
+    tv.push_back( it->second );
+
+  sort( tv.begin(), tv.end(),
+        [] (const total_s& a, const total_s& b) { return( a.dur > b.dur ); } );
+
+  ios::fmtflags f = os.flags();
+
+  os << setw(20) << left << "function" << right
+     << setw(8)  << "calls"
+     << setw(12) << "total ms"
+     << setw(12) << "child ms"
+     << setw(12) << "bytes"
+     << setw(8)  << "hits" << endl;
+
+  for ( size_t i=0; i < tv.size() && i < c; ++i )
+  {
+    os << setw(20) << left << tv[i].name << right
+       << setw(8)  << tv[i].calls
+       << setw(12) << fixed << setprecision(3) << tv[i].dur / 1000.0
+       << setw(12) << tv[i].child / 1000.0
+       << setw(12) << tv[i].bytes
+       << setw(8)  << tv[i].hits << endl;
+  }
+
+  os.flags( f );
+}
+
+
+////////////////////////////////////////////////////////////////////////////////
+// UTIL
+////////////////////////////////////////////////////////////////////////////////
+
+namespace {
+
+  //! table lookup scan for the first member of k.
+  size_t
+  find_in_table(const char* s, const size_t n, const ODIF::char_class& k)
+  {
+    for ( size_t i = 0; i < n; ++i )
+      if ( k.has( s[i] ) ) return( i );
+
+    return( string::npos );
+  }
+
+#if defined(ODIF_SIMD_X86)
+  //! 16-byte vector scan for the first member of k (at most list_max members).
+  __attribute__((target("sse2"))) size_t
+  find_in_sse2(const char* s, const size_t n, const ODIF::char_class& k)
+  {
+    const size_t m = k.size();
+    __m128i c[ ODIF::char_class::list_max ];
+
+    for ( size_t j = 0; j < m; ++j )
+      c[j] = _mm_set1_epi8( static_cast<char>( k.list()[j] ) );
+
+    size_t i = 0;
+    for ( ; i + 16 <= n; i += 16 )
+    {
+      const __m128i v = _mm_loadu_si128( reinterpret_cast<const __m128i*>( s + i ) );
+      __m128i e = _mm_cmpeq_epi8( v, c[0] );
+
+      for ( size_t j = 1; j < m; ++j )
+        e = _mm_or_si128( e, _mm_cmpeq_epi8( v, c[j] ) );
+
+      if ( const int b = _mm_movemask_epi8( e ) )
+        return( i + __builtin_ctz( b ) );
+    }
+
+    const size_t r = find_in_table( s + i, n - i, k );
+    return( r == string::npos ? r : i + r );
+  }
+
+  //! 32-byte vector scan for the first member of k (at most list_max members).
+  __attribute__((target("avx2"))) size_t
+  find_in_avx2(const char* s, const size_t n, const ODIF::char_class& k)
+  {
+    const size_t m = k.size();
+    __m256i c[ ODIF::char_class::list_max ];
+
+    for ( size_t j = 0; j < m; ++j )
+      c[j] = _mm256_set1_epi8( static_cast<char>( k.list()[j] ) );
+
+    size_t i = 0;
+    for ( ; i + 32 <= n; i += 32 )
+    {
+      const __m256i v = _mm256_loadu_si256( reinterpret_cast<const __m256i*>( s + i ) );
+      __m256i e = _mm256_cmpeq_epi8( v, c[0] );
+
+      for ( size_t j = 1; j < m; ++j )
+        e = _mm256_or_si256( e, _mm256_cmpeq_epi8( v, c[j] ) );
+
+      if ( const unsigned b = static_cast<unsigned>( _mm256_movemask_epi8( e ) ) )
+        return( i + __builtin_ctz( b ) );
+    }
+
+    const size_t r = find_in_sse2( s + i, n - i, k );
+    return( r == string::npos ? r : i + r );
+  }
+#endif
+
+  //! detect the highest kernel level supported by the processor.
+  UTIL::simd_level
+  simd_detect(void)
+  {
+#if defined(ODIF_SIMD_X86)
+    __builtin_cpu_init();
+
+    if ( __builtin_cpu_supports( "avx2" ) ) return( UTIL::simd_avx2 );
+    if ( __builtin_cpu_supports( "sse2" ) ) return( UTIL::simd_sse2 );
+#endif
+
+    return( UTIL::simd_none );
+  }
+
+  //! kernel level in use.
+  UTIL::simd_level&
+  simd_level_used(void)
+  {
+    static UTIL::simd_level l = UTIL::simd_supported();
+    return( l );
+  }
+}
+
+UTIL::simd_level
+UTIL::simd_supported(void)
+{
+  static const simd_level l = simd_detect();
+  return( l );
+}
+
+UTIL::simd_level
+UTIL::simd_active(void)
+{
+  return( simd_level_used() );
+}
+
+UTIL::simd_level
+UTIL::simd_select(const simd_level l)
+{
+  simd_level_used() = std::min( l, simd_supported() );
+  return( simd_level_used() );
+}
+
+const char*
+UTIL::simd_name(const simd_level l)
+{
+  switch ( l )
+  {
+    case simd_sse2: return( "sse2" );
+    case simd_avx2: return( "avx2" );
+    default:        return( "none" );
+  }
+}
+
+size_t
+UTIL::find_in(const char* s, const size_t n, const ODIF::char_class& k)
+{
+  if ( k.size() == 0 )
+    return( string::npos );
+
+  // single member: the library search is already vectorized
+  if ( k.size() == 1 )
+  {
+    const void* p = memchr( s, k.list()[0], n );
+    return( p ? static_cast<const char*>( p ) - s : string::npos );
+  }
+
+#if defined(ODIF_SIMD_X86)
+  if ( k.size() <= ODIF::char_class::list_max )
+  {
+    switch ( simd_level_used() )
+    {
+      case simd_avx2: return( find_in_avx2( s, n, k ) );
+      case simd_sse2: return( find_in_sse2( s, n, k ) );
+      default:        break;
+    }
+  }
+#endif
+
+  return( find_in_table( s, n, k ) );
+}
+
+size_t
+UTIL::find_not_in(const char* s, const size_t n, const ODIF::char_class& k)
+{
+  for ( size_t i = 0; i < n; ++i )
+    if ( !k.has( s[i] ) ) return( i );
+
+  return( string::npos );
+}
+
+size_t
+UTIL::rfind_in(const char* s, const size_t n, const ODIF::char_class& k)
+{
+  for ( size_t i = n; i > 0; --i )
+    if ( k.has( s[i-1] ) ) return( i-1 );
+
+  return( string::npos );
+}
+
+size_t
+UTIL::rfind_not_in(const char* s, const size_t n, const ODIF::char_class& k)
+{
+  for ( size_t i = n; i > 0; --i )
+    if ( !k.has( s[i-1] ) ) return( i-1 );
+
+  return( string::npos );
+}
+
+void
+UTIL::replace_in(const char* s, const size_t n, const ODIF::char_class& k,
+                 const char c, string& r)
+{
+  r.reserve( r.length() + n );
+
+  size_t i = 0;
+  while ( i < n )
+  {
+    const size_t f = find_in( s + i, n - i, k );
+
+    if ( f == string::npos )
+    {
+      r.append( s + i, n - i );
+      break;
+    }
+
+    // copy the run before the member, then its replacement
+    r.append( s + i, f );
+    if ( c != '\0' ) r.push_back( c );
+
+    i += f + 1;
+  }
+}
+
+uint64_t
+UTIL::hash_fnv1a(const char* s, const size_t l, const uint64_t h)
+{
+  uint64_t r = h;
+
+  for ( size_t i = 0; i < l; ++i )
+  {
+    r ^= static_cast<unsigned char>( s[i] );
+    r *= 1099511628211ULL;
+  }
+
+  return ( r );
+}
+
+#if defined(HAVE_FORK) && defined(HAVE_PIPE) && defined(HAVE_POLL)
+namespace {
+
+  // return milliseconds of a monotonic clock.
+  int64_t
+  now_ms(void)
+  {
+    return ( chrono::duration_cast<chrono::milliseconds>
+             ( chrono::steady_clock::now().time_since_epoch() ).count() );
+  }
+
+  // run command c with the shell under limits l and capture its output
+  // to r; on failure r is the reason.
+  bool
+  sys_command_limited(const string& c, const UTIL::proc_limits& l, string& r)
+  {
+    int fd[2];
+
+    if ( UTIL::pipe_cloexec( fd ) != 0 )
+    {
+      r = "pipe() failed for " + c;
+      return ( false );
+    }
+
+    pid_t pid = fork();
+
+    if ( pid < 0 )
+    {
+      close( fd[0] );
+      close( fd[1] );
+
+      r = "fork() failed for " + c;
+      return ( false );
+    }
+
+    if ( pid == 0 )
+    { // child: own process group, limits, and output to the pipe
+      setpgid( 0, 0 );
+
+#if defined(HAVE_SETRLIMIT)
+      if ( l.cpu )
+      { // soft limit signals SIGXCPU, hard limit kills
+        struct rlimit rl = { l.cpu, l.cpu + 1 };
+        setrlimit( RLIMIT_CPU, &rl );
+      }
+
+      if ( l.mem )
+      {
+        rlim_t b = static_cast<rlim_t>(l.mem) * 1024 * 1024;
+        struct rlimit rl = { b, b };
+        setrlimit( RLIMIT_AS, &rl );
+      }
+#endif
+
+      close( fd[0] );
+      dup2( fd[1], STDOUT_FILENO );
+      close( fd[1] );
+
+      execl( "/bin/sh", "sh", "-c", c.c_str(), static_cast<char*>(NULL) );
+      _exit( 127 );
+    }
+
+    // parent: also set the group to avoid racing the child
+    setpgid( pid, pid );
+    close( fd[1] );
+
+    const int64_t deadline = l.timeout ? now_ms() + int64_t(l.timeout) * 1000 : 0;
+    bool expired = false;
+
+    // read output until end of file or the deadline
+    char buffer[4096];
+
+    for (;;)
+    {
+      int wait_ms = -1;
+
+      if ( deadline )
+      {
+        int64_t left = deadline - now_ms();
+
+        if ( left <= 0 ) { expired = true; break; }
+        wait_ms = static_cast<int>( left );
+      }
+
+      struct pollfd pfd = { fd[0], POLLIN, 0 };
+      int n = poll( &pfd, 1, wait_ms );
+
+      if ( n < 0 && errno == EINTR ) continue;
+      if ( n < 0 ) break;
+      if ( n == 0 ) { expired = true; break; }
+
+      ssize_t rn = read( fd[0], buffer, sizeof(buffer) );
+
+      if ( rn < 0 && errno == EINTR ) continue;
+      if ( rn <= 0 ) break;
+
+      r.append( buffer, rn );
+    }
+
+    close( fd[0] );
+
+    // wait for the shell, within the deadline
+    int status = 0;
+
+    while ( !expired )
+    {
+      pid_t w = waitpid( pid, &status, deadline ? WNOHANG : 0 );
+
+      if ( w == pid ) break;
+      if ( w < 0 && errno != EINTR ) break;
+
+      if ( w == 0 )
+      {
+        if ( now_ms() >= deadline ) expired = true;
+        else                        usleep( 10000 );
+      }
+    }
+
+    if ( expired )
+    {
+      kill( -pid, SIGKILL );
+      waitpid( pid, &status, 0 );
+
+      r = "command exceeded time limit of " + UTIL::to_string( l.timeout )
+        + " seconds: " + c;
+      return ( false );
+    }
+
+    if ( WIFSIGNALED( status ) )
+    {
+      int sig = WTERMSIG( status );
+
+      // stop any remaining processes of the group
+      kill( -pid, SIGKILL );
+
+      if ( l.cpu && ( sig == SIGXCPU || sig == SIGKILL ) )
+        r = "command exceeded cpu limit of " + UTIL::to_string( l.cpu )
+          + " seconds: " + c;
+      else
+        r = "command terminated by signal " + UTIL::to_string( sig )
+          + ( l.mem ? " (memory limit " + UTIL::to_string( l.mem ) + " MiB)" : "" )
+          + ": " + c;
+
+      return ( false );
+    }
+
+    return ( true );
+  }
+
+}
+#endif
+
+void
+UTIL::sys_command(
+  const string& command,
+        string& result,
+        bool& success,
+  const bool& standard_error,
+  const bool& replace_newlines,
+  const proc_limits& l)
+{
+  string cmd_str( command );
+
+  if ( standard_error )
+    cmd_str.append(" 2>&1");
+
+#if defined(HAVE_FORK) && defined(HAVE_PIPE) && defined(HAVE_POLL)
+  if ( l.any() )
+  {
+    success = sys_command_limited( cmd_str, l, result );
+
+    if ( replace_newlines )
+      result = UTIL::replace_chars(result, "\n\r", ' ');
+
+    return;
+  }
+#else
+  if ( l.any() )
+  {
+    result = "process limits not supported, unable to execute " + cmd_str;
+
+    success=false;
+    return;
+  }
+#endif
+
+#ifdef HAVE_POPEN
+  FILE* pipe;
+  char buffer[128];
+
+  pipe = popen( cmd_str.c_str(), "r" );
+
+  if (!pipe)
+  {
+    result = "popen() failed for " + cmd_str;
+
+    success=false;
+  }
+  else
+  {
+    while ( !feof(pipe) )
+    {
+      if ( fgets(buffer, 128, pipe) != NULL )
+          result.append( buffer );
+    }
+
+    pclose(pipe);
+
+    success=true;
+  }
+#else /* HAVE_POPEN */
+  result = "popen() not available, unable to execute " + cmd_str;
+
+  success=false;
+#endif /* HAVE_POPEN */
+
+  if ( replace_newlines )
+    result = UTIL::replace_chars(result, "\n\r", ' ');
+}
+
+size_t
+UTIL::get_indent(const std::string& t)
+{
+  ODIF::line_view v( t );
+
+  // move to first non-empty line
+  while ( v.next() )
+  {
+    if ( v.length() == 0 )
+      continue;
+
+    for ( size_t i=0; i < v.length(); ++i )
+      if ( v.line()[i] != ' ' && v.line()[i] != '\t' )
+        return ( i );
+
+    break;
+  }
+
+  return ( string::npos );
+}
+
+string
+UTIL::indent_line(const string& l, const int n)
+{
+  string new_line;
+
+  new_line.reserve( max(n, 0) + l.length() );
+  new_line.append( max(n, 0), ' ' );
+  new_line.append( l );
+
+  return new_line;
+}
+
+string
+UTIL::indent_text(const string& t, const int n)
+{
+  const size_t i = max(n, 0);
+
+  ODIF::line_view v( t );
+  string new_text;
+
+  // each line gains i spaces and a newline
+  new_text.reserve( t.length() + 1
+                    + ODIF::line_view::count( t.data(), t.length() ) * i );
+
+  while ( v.next() )
+  {
+    new_text.append( i, ' ' );
+    new_text.append( v.line(), v.length() );
+    new_text.append( 1, '\n' );
+  }
+
+  return new_text;
+}
+
+namespace
+{
+  //! return the word list of text w split on white space. lists of
+  //! recent texts are kept, so that selecting each word of a list in
+  //! turn splits it once.
+  const ODIF::word_list&
+  space_words(const string& w)
+  {
+    static thread_local ODIF::word_list_cache c( 4 );
+
+    return( c.get( w, " \f\n\r\t\v" ) );
+  }
+}
+
+string
+UTIL::get_word(const string& w, const int n)
+{
+  const ODIF::word_list& wl = space_words( w );
+
+  if ( n < 1 || static_cast<size_t>(n) > wl.size() )
+    return( string() );
+
+  return( wl[ n - 1 ] );
+}
+
+size_t
+UTIL::word_count(const string& w)
+{
+  return( space_words( w ).size() );
+}
+
+string
+UTIL::remove_chars(const string &s, const string &c)
+{
+  return ( replace_chars(s, c, '\0') );
+}
+
+string
+UTIL::replace_chars(const string &s, const string &c, const char r)
+{
+  string result;
+
+  replace_in( s.data(), s.length(), ODIF::char_class( c ), r, result );
+
+  return( result );
+}
+
+string
+UTIL::unquote(const string &s)
+{
+  size_t b, l;
+
+  unquote_bounds( s, b, l );
+
+  return( s.substr( b, l ) );
+}
+
+void
+UTIL::unquote_bounds(const string &s, size_t& b, size_t& l)
+{
+  b = 0;
+  l = s.length();
+
+  // remove outermost matching quotations
+  // (1) quotes must be outermost text, excluding whitespace
+  // (2) quotes must be matching set
+  // (3) leading and trailing whitespace before and after
+  //     the outermost quotation are discarded.
+
+  static const ODIF::char_class ws( " \f\n\r\t\v" );
+  static const ODIF::char_class qc( "\"\'" );
+
+  const char* d = s.data();
+
+  // locate outer bounds of non-white space text
+  size_t fc = find_not_in( d, l, ws );
+  size_t lc = rfind_not_in( d, l, ws );
+
+  // locate outermost quotations
+  size_t fq = find_in( d, l, qc );
+  size_t lq = rfind_in( d, l, qc );
+
+  // unquote iff:
+  // (1) not one in the same (character or string::npos)
+  // (2) first non-white space character is first quote
+  // (3) last non-white space character is last quote
+  // (4) the quote characters are a matched pair
+  if ( (fq != lq) && (fc == fq) && (lc == lq) )
+  { // quotate character must match: ie '' or ""
+    if ( s.at(fq) == s.at(lq) )
+    {
+      // text between quotes (empty for the quoted null string "")
+      b = fq+1;
+      l = lq-1-fq;
+    }
+  }
+}
+
+string
+UTIL::unquote_trim(const string &s)
+{
+  return ( boost::trim_copy( unquote( s ) ) );
+}
+
+string
+UTIL::to_string(const long v)
+{
+  ostringstream os;
+
+  os << dec << v;
+
+  return ( os.str() );
+}
+
+bool
+UTIL::is_number(const std::string& s)
+{
+  string::const_iterator it = s.begin();
+
+  while ( it != s.end() && isdigit(*it) )
     ++it;
 
   return ( !s.empty() && it == s.end() );
@@ -858,42 +3302,56 @@ UTIL::to_roman_numeral(const int &n)
   return ( rn );
 }
 
-std::string
-UTIL::openscad_rmecho_line(const std::string &line)
+namespace
 {
-  //
-  // OpenSCAD ECHO format: [[ECHO:][ ][" ... echo-content ... "]endl]
-  //
+  //! append line l of length n to r without its OpenSCAD ECHO format.
+  void
+  rmecho_append(const char* l, size_t n, std::string& r)
+  {
+    //
+    // OpenSCAD ECHO format: [[ECHO:][ ][" ... echo-content ... "]endl]
+    //
 
-  std::string new_line = line;
+    // [ECHO:]
+    if ( n >= 5 && memcmp( l, "ECHO:", 5 ) == 0 )
+    { // 'ECHO:' iff at pos==0
+      l += 5; n -= 5;
 
-  // [ECHO:]
-  if ( new_line.find( "ECHO:" ) == 0 )
-  { // 'ECHO:' iff at pos==0
-    new_line.erase( 0, 5 );
+      // [ ] all white space from pos==0
+      size_t p = 0;
+      while ( p < n && (l[p] == ' ' || l[p] == '\t') )
+        ++p;
 
-    // [ ] single space character at pos==0
-    // if ( new_line.find_first_of( " " ) == 0 )
-    //  new_line.erase( 0, 1 );
+      if ( p != n )
+      {
+        l += p; n -= p;
+      }
 
-    // [ ] all white space from pos==0
-    size_t p = new_line.find_first_not_of( " \t" );
-    if ( (p != 0) && (p != string::npos) )
-      new_line.erase( 0, p );
+      // [" ... echo-content ... "]
+      if ( n != 0 && l[0] == '"' )
+      { // open quote at pos==0
+        l += 1; n -= 1;
 
-    // [" ... echo-content ... "]
-    if ( new_line.find_first_of( "\"" ) == 0 )
-    { // open quote at pos==0
-      new_line.erase( 0, 1 );
+        // close quote at pos=eol
+        if ( n != 0 && l[n-1] == '"' )
+          r.append( l, n-1 );
+        else
+          r.append( l, n ).append( "<ERROR: close quote missing>" );
 
-      // close quote at pos=eol
-      size_t l = new_line.length();
-      if ( (l != 0) && (new_line.find_last_of( "\"" ) == (l-1)) )
-        new_line.erase( l-1, 1 );
-      else
-        new_line.append( "<ERROR: close quote missing>" );
+        return;
+      }
     }
+
+    r.append( l, n );
   }
+}
+
+std::string
+UTIL::openscad_rmecho_line(const std::string &line)
+{
+  std::string new_line;
+
+  rmecho_append( line.data(), line.length(), new_line );
 
   return ( new_line );
 }
@@ -901,21 +3359,366 @@ UTIL::openscad_rmecho_line(const std::string &line)
 std::string
 UTIL::openscad_rmecho_text(const std::string &text)
 {
-  istringstream iss(text);
+  ODIF::line_view v( text );
   string new_text;
 
-  while ( !iss.eof() )
+  // lines only shrink, except for missing close quote messages
+  new_text.reserve( text.length() + 1 );
+
+  while ( v.next() )
+  {
+    rmecho_append( v.line(), v.length(), new_text );
+    new_text.append( 1, '\n' );
+  }
+
+  return new_text;
+}
+
+uint64_t
+UTIL::hash_file(const std::string &f)
+{
+  ifstream ifs( f.c_str(), ios::binary );
+
+  uint64_t h = hash_fnv1a( NULL, 0 );
+  char buf[65536];
+
+  while ( ifs.read( buf, sizeof(buf) ) || ifs.gcount() > 0 )
+    h = hash_fnv1a( buf, ifs.gcount(), h );
+
+  return ( h );
+}
+
+bool
+UTIL::copy_policy_parse(const std::string &n, copy_policy &p)
+{
+  if      ( n == "copy" )     p = copy_data;
+  else if ( n == "hardlink" ) p = copy_hardlink;
+  else if ( n == "reflink" )  p = copy_reflink;
+  else if ( n == "symlink" )  p = copy_symlink;
+  else
+    return ( false );
+
+  return ( true );
+}
+
+std::string
+UTIL::copy_policy_name(const copy_policy p)
+{
+  switch ( p )
   {
-    string line;
+    case copy_hardlink: return ( "hardlink" );
+    case copy_reflink:  return ( "reflink" );
+    case copy_symlink:  return ( "symlink" );
+    default:            return ( "copy" );
+  }
+}
+
+bool
+UTIL::copy_asset(const std::string &s, const std::string &t,
+                 const copy_policy p, copy_policy &u, std::string &m)
+{
+  namespace bfs = boost::filesystem;
+  boost::system::error_code ec;
+
+  // build at a unique name beside the target and rename over it, so a
+  // reader never sees a partial file and links can replace a target.
+  string w = t + bfs::unique_path( ".%%%%-%%%%.tmp" ).string();
 
-    getline(iss, line);
-    line = UTIL::openscad_rmecho_line(line);
+  u = copy_data;
 
-    new_text.append( line );
-    new_text.append( "\n" );
+  if ( p == copy_hardlink )
+  {
+    bfs::create_hard_link( s, w, ec );
+    if ( !ec ) u = copy_hardlink;
+  }
+  else if ( p == copy_symlink )
+  {
+    bfs::create_symlink( bfs::canonical( s, ec ), w, ec );
+    if ( !ec ) u = copy_symlink;
   }
+#if defined(HAVE_LINUX_FS_H) && defined(HAVE_SYS_IOCTL_H) && defined(FICLONE)
+  else if ( p == copy_reflink )
+  {
+    int sfd = open( s.c_str(), O_RDONLY );
+    int tfd = ( sfd < 0 ) ? -1 : open( w.c_str(), O_WRONLY|O_CREAT|O_TRUNC, 0666 );
 
-  return new_text;
+    if ( tfd >= 0 && ioctl( tfd, FICLONE, sfd ) == 0 )
+      u = copy_reflink;
+
+    if ( tfd >= 0 ) close( tfd );
+    if ( sfd >= 0 ) close( sfd );
+  }
+#endif
+
+  // fall back to a data copy (cross-device link, unsupported reflink).
+  if ( u == copy_data )
+  {
+    ec.clear();
+    bfs::copy_file( s, w, bfs::copy_option::overwrite_if_exists, ec );
+  }
+
+  if ( !ec )
+    bfs::rename( w, t, ec );
+
+  if ( ec )
+  {
+    boost::system::error_code rc;
+    bfs::remove( w, rc );
+
+    m = "unable to " + copy_policy_name( u ) + " [" + s + "] to ["
+      + t + "], " + ec.message();
+
+    return ( false );
+  }
+
+  m = copy_policy_name( u );
+
+  return ( true );
+}
+
+bool
+UTIL::openscad_outputs_exist(const std::string &a)
+{
+  vector<string> t = string_tokenize_to_vector( a, " \t\n\r" );
+
+  for ( size_t i=0; i<t.size(); ++i )
+  {
+    string o;
+
+    // forms: -o <f>, --o <f>, -o=<f>, --o=<f>
+    if ( (t[i] == "-o" || t[i] == "--o") && (i+1) < t.size() )
+      o = t[++i];
+    else if ( t[i].compare(0, 3, "-o=") == 0 )
+      o = t[i].substr(3);
+    else if ( t[i].compare(0, 4, "--o=") == 0 )
+      o = t[i].substr(4);
+    else
+      continue;
+
+    if ( !boost::filesystem::exists( unquote( o ) ) )
+      return ( false );
+  }
+
+  return ( true );
+}
+
+string
+UTIL::file_identity(const std::string &f)
+{
+  boost::system::error_code ec;
+  boost::filesystem::path p( f );
+
+  // locate executable names without a directory in ${PATH}
+  if ( !p.has_parent_path() && getenv("PATH") != NULL )
+  {
+    vector<string> d = string_tokenize_to_vector( getenv("PATH"), ":" );
+
+    for ( vector<string>::iterator it=d.begin(); it!=d.end(); ++it )
+    {
+      boost::filesystem::path t = boost::filesystem::path( *it ) / p;
+      if ( boost::filesystem::is_regular_file( t, ec ) ) { p = t; break; }
+    }
+  }
+
+  uintmax_t z = boost::filesystem::file_size( p, ec );
+  if ( ec )
+    return ( p.string() + " <missing>" );
+
+  time_t m = boost::filesystem::last_write_time( p, ec );
+
+  return ( p.string() + " " + to_string( z ) + " " + to_string( m ) );
+}
+
+
+namespace {
+
+  // return s escaped for a make rule.
+  string
+  make_escape(const string& s)
+  {
+    string r;
+
+    for ( string::const_iterator it=s.begin(); it!=s.end(); ++it )
+    {
+      if      ( *it == ' ' || *it == '#' || *it == '\\' ) r += '\\';
+      else if ( *it == '$' )                            r += '$';
+
+      r += *it;
+    }
+
+    return ( r );
+  }
+
+  // modification time of st in nanoseconds.
+  long long
+  mtime_ns(const struct stat& st)
+  {
+#if defined(HAVE_STRUCT_STAT_ST_MTIM)
+    return ( static_cast<long long>(st.st_mtime) * 1000000000LL + st.st_mtim.tv_nsec );
+#else
+    return ( static_cast<long long>(st.st_mtime) * 1000000000LL );
+#endif
+  }
+
+}
+
+/*
+  dependency file format (as gcc -MD -MP):
+
+    <target>: \
+     <file> \
+     <file>
+    <file>:
+    <file>:
+
+  the empty rules keep make from failing when a file is removed.
+*/
+
+bool
+UTIL::depfile_write(const string &f, const string &t, const set<string> &d)
+{
+  string tmp = f + ".tmp";
+  ofstream ofs( tmp.c_str(), ios::trunc );
+
+  if ( !ofs.is_open() )
+    return ( false );
+
+  ofs << make_escape( t ) << ":";
+  for ( set<string>::const_iterator it=d.begin(); it!=d.end(); ++it )
+    ofs << " \\\n " << make_escape( *it );
+  ofs << "\n";
+
+  for ( set<string>::const_iterator it=d.begin(); it!=d.end(); ++it )
+    ofs << "\n" << make_escape( *it ) << ":\n";
+
+  ofs.close();
+
+  if ( !ofs || rename( tmp.c_str(), f.c_str() ) != 0 )
+  {
+    remove( tmp.c_str() );
+    return ( false );
+  }
+
+  return ( true );
+}
+
+bool
+UTIL::depfile_check(const string &f, string &c)
+{
+  struct stat fst;
+  ifstream ifs( f.c_str(), ios::binary );
+
+  if ( !ifs.is_open() || stat( f.c_str(), &fst ) != 0 )
+  {
+    c = "unable to read " + f;
+    return ( false );
+  }
+
+  const long long fmt = mtime_ns( fst );
+
+  // prerequisites of the first rule, joining continued lines
+  string line, rule;
+  while ( getline( ifs, line ) )
+  {
+    if ( !line.empty() && line[line.size()-1] == '\\'
+         && ( line.size() < 2 || line[line.size()-2] != '\\' ) )
+    {
+      rule += line.substr( 0, line.size()-1 ) + " ";
+      continue;
+    }
+
+    rule += line;
+    break;
+  }
+
+  // skip the target
+  size_t i = 0;
+  for ( ; i < rule.size() && rule[i] != ':'; ++i )
+    if ( rule[i] == '\\' ) ++i;
+
+  if ( i >= rule.size() )
+  {
+    c = "no rule in " + f;
+    return ( false );
+  }
+
+  // test each unescaped file name
+  string name;
+  for ( ++i; i <= rule.size(); ++i )
+  {
+    char ch = ( i < rule.size() ) ? rule[i] : ' ';
+
+    if ( ch == '\\' && i+1 < rule.size() )
+      name += rule[++i];
+    else if ( ch == '$' && i+1 < rule.size() && rule[i+1] == '$' )
+      name += rule[++i];
+    else if ( ch != ' ' && ch != '\t' )
+      name += ch;
+    else if ( !name.empty() )
+    {
+      struct stat st;
+
+      if ( stat( name.c_str(), &st ) != 0 || mtime_ns( st ) > fmt )
+      {
+        c = name;
+        return ( false );
+      }
+
+      name.clear();
+    }
+  }
+
+  return ( true );
+}
+
+void
+UTIL::openscad_depends(const std::string &t,
+                       const std::string &d,
+                       const std::vector<std::string> &p,
+                       std::string &k,
+                       std::set<std::string> &v)
+{
+  static const boost::regex re( "\\b(include|use)\\s*<([^>\\n]+)>" );
+
+  boost::sregex_iterator it( t.begin(), t.end(), re ), end;
+  for ( ; it != end; ++it )
+  {
+    string n = (*it)[2].str();
+
+    // resolve: script directory, then library paths.
+    boost::system::error_code ec;
+    boost::filesystem::path f;
+
+    vector<string> s( 1, d );
+    s.insert( s.end(), p.begin(), p.end() );
+
+    for ( vector<string>::iterator sit=s.begin(); sit!=s.end(); ++sit )
+    {
+      boost::filesystem::path c = boost::filesystem::path( *sit ) / n;
+      if ( boost::filesystem::is_regular_file( c, ec ) ) { f = c; break; }
+    }
+
+    if ( f.empty() )
+    {
+      k += n + " <missing>\n";
+      continue;
+    }
+
+    string c = boost::filesystem::canonical( f, ec ).string();
+    if ( !v.insert( c ).second )
+      continue;
+
+    k += file_identity( c ) + "\n";
+
+    // nested dependencies
+    ifstream ifs( c.c_str() );
+    if ( ifs.good() )
+    {
+      string ft( (istreambuf_iterator<char>( ifs )), istreambuf_iterator<char>() );
+
+      openscad_depends( ft, f.parent_path().string(), p, k, v );
+    }
+  }
 }
 
 /*
@@ -930,16 +3733,92 @@ UTIL::string_tokenize_to_vector(
   const boost::empty_token_policy empty_tokens
 )
 {
-  typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
+  // the token rules of boost::char_separator, with class table lookups
+  // and the delimiter scan done by the character kernels.
+  static const ODIF::char_class ws( " \f\n\r\t\v" );
 
-  boost::char_separator<char>
-      field_separators( toks.c_str(), toks_keep.c_str(), empty_tokens );
+  const ODIF::char_class dropped( toks );
+  const ODIF::char_class kept( toks_keep );
+  ODIF::char_class delims( toks );
+  delims.add( toks_keep );
 
-  tokenizer str_tokens( str, field_separators );
+  const char* d = str.data();
+  const size_t n = str.length();
 
   vector<string> str_vector;
-  for ( tokenizer::iterator it=str_tokens.begin(); it!=str_tokens.end(); ++it )
-    str_vector.push_back( boost::trim_copy( *it ) );
+
+  size_t next = 0;
+  bool done = false;                            // token output at position
+
+  // as with boost::tokenizer, empty text has no tokens (not one empty)
+  while ( n != 0 )
+  {
+    size_t start;
+
+    if ( empty_tokens == boost::drop_empty_tokens )
+    {
+      // skip dropped delimiters
+      const size_t f = find_not_in( d + next, n - next, dropped );
+      if ( f == string::npos ) break;
+
+      next += f;
+      start = next;
+
+      // a kept delimiter is a token, else up to the next delimiter
+      if ( kept.has( d[next] ) )
+        ++next;
+      else
+      {
+        const size_t e = find_in( d + next, n - next, delims );
+        next = ( e == string::npos ) ? n : next + e;
+      }
+    }
+    else
+    {
+      start = next;
+
+      if ( next == n )
+      { // empty token at the end
+        if ( done ) break;
+        done = true;
+      }
+      else if ( kept.has( d[next] ) )
+      { // empty token before, then the kept delimiter
+        if ( !done )
+          done = true;
+        else
+        {
+          ++next;
+          done = false;
+        }
+      }
+      else if ( !done && dropped.has( d[next] ) )
+      { // empty token before a dropped delimiter
+        done = true;
+      }
+      else
+      {
+        if ( dropped.has( d[next] ) )
+          start = ++next;
+
+        const size_t e = find_in( d + next, n - next, delims );
+        next = ( e == string::npos ) ? n : next + e;
+        done = true;
+      }
+    }
+
+    // trimmed token
+    const size_t l = next - start;
+    const size_t tf = find_not_in( d + start, l, ws );
+
+    if ( tf == string::npos )
+      str_vector.push_back( string() );
+    else
+      str_vector.push_back
+      (
+        string( d + start + tf, rfind_not_in( d + start, l, ws ) + 1 - tf )
+      );
+  }
 
   return ( str_vector );
 }
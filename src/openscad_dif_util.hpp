@@ -40,11 +40,48 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <bitset>
+#include <ctime>
 #include <map>
+#include <set>
+#include <list>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <stdint.h>
 
 //! \ingroup openscad_dif_src
 //! @{
 
+namespace UTIL{
+
+  //! asset copy methods.
+  enum copy_policy
+  {
+    copy_data,                          //!< copy file data.
+    copy_hardlink,                      //!< create a hard link.
+    copy_reflink,                       //!< clone file data (copy-on-write).
+    copy_symlink                        //!< create a symbolic link.
+  };
+
+  //! child process limits (zero for no limit).
+  struct proc_limits
+  {
+    proc_limits(void) : timeout(0), cpu(0), mem(0) {}
+
+    unsigned    timeout;                //!< wall time (seconds).
+    unsigned    cpu;                    //!< cpu time (seconds).
+    unsigned    mem;                    //!< address space (MiB).
+
+    //! test if any limit is set.
+    bool any(void) const { return( timeout || cpu || mem ); }
+  };
+
+} /* end namespace UTIL */
+
+
 namespace ODIF{
 
 //! Class to manage environment variables.
@@ -69,7 +106,7 @@ class env_var {
     ~env_var(void);
 
     //! clear all stored environment variables.
-    void clear(void) { map.clear(); }
+    void clear(void);
 
     //! set variable prefix.
     void set_prefix(const std::string& s) { prefix=s; }
@@ -110,13 +147,25 @@ class env_var {
     std::string get_report_message(void) { return ( report_message ); }
 
     //! test for the existence of variable name n
-    bool exists(const std::string& n) { return( map.find( n ) != map.end() ); }
+    bool exists(const std::string& n) { return( find( n.data(), n.length() ) != npos ); }
 
     //! store a variable name and value pair.
-    void store(const std::string& n, const std::string& v) { map[ n ] = v; }
+    void store(const std::string& n, const std::string& v);
 
     //! erase a named variable.
-    void erase(const std::string& n) { map.erase( n ); }
+    void erase(const std::string& n);
+
+    //! \brief return the generation of variable name n, else zero.
+    //! \details each store gives the value a new generation (unique
+    //!          across maps and kept by copies), so that data derived
+    //!          from a value may be tested for currency without
+    //!          comparing the value text.
+    size_t generation(const std::string& n)
+      { const size_t ei = find( n.data(), n.length() );
+        return( ei != npos ? entries[ ei ].val_gen : 0 ); }
+
+    //! return the number of stored variables.
+    size_t size(void) { return ( live_count ); }
 
     //! \brief expand a variable.
     //! \param v  formatted variable name (prefix+name+suffix).
@@ -155,6 +204,13 @@ class env_var {
     //! simple dump of all variables to standard out.
     void dump(void);
 
+    //! get the number of variable lookups performed (all maps).
+    static size_t get_lookup_count(void) { return ( lookup_count ); }
+    //! get the number of variable stores performed (all maps).
+    static size_t get_store_count(void) { return ( store_count ); }
+    //! get the number of stores that reused an existing value buffer (all maps).
+    static size_t get_reuse_count(void) { return ( reuse_count ); }
+
   private:
     std::string     prefix;               //!< variable prefix.
     std::string     suffix;               //!< variable suffix.
@@ -167,8 +223,38 @@ class env_var {
     bool            report;               //!< report non-existent variables.
     std::string     report_message;       //!< report message for non-existent variables.
 
-    std::map<std::string,
-             std::string> map;            //!< variable storage map.
+    //! variable table entry. key and value are stored in the arena.
+    struct entry_s {
+      size_t        hash;                 //!< hash of the variable name.
+      size_t        key_off;              //!< name offset in arena.
+      size_t        key_len;              //!< name length.
+      size_t        val_off;              //!< value offset in arena.
+      size_t        val_len;              //!< value length.
+      size_t        val_cap;              //!< value buffer capacity.
+      size_t        val_gen;              //!< value generation (store count).
+      bool          live;                 //!< variable is defined.
+    };
+
+    static const size_t npos = static_cast<size_t>(-1);  //!< no entry.
+
+    std::vector<size_t>  slots;           //!< open-addressing table of entry indexes.
+    std::vector<entry_s> entries;         //!< interned variable entries.
+    std::string          arena;           //!< name and value storage.
+    size_t               live_count;      //!< number of defined variables.
+    size_t               arena_waste;     //!< unreferenced bytes in arena.
+
+    static size_t        lookup_count;    //!< variable lookups (all maps).
+    static size_t        store_count;     //!< variable stores (all maps).
+    static size_t        reuse_count;     //!< value buffer reuses (all maps).
+
+    //! return the entry index for the variable name n of length l, or npos.
+    size_t find(const char* n, const size_t l);
+    //! return the slot for name n of length l with hash h (empty slot when new).
+    size_t find_slot(const char* n, const size_t l, const size_t h) const;
+    //! grow the slot table and reinsert all entries.
+    void rehash(const size_t c);
+    //! rewrite the arena without unreferenced value buffers.
+    void compact(void);
 };
 
 
@@ -277,15 +363,1015 @@ class func_args {
 };
 
 
+//! Built-in function option value types.
+enum opt_type {
+  opt_text,                             //!< unquoted text.
+  opt_trim,                             //!< unquoted and trimmed text.
+  opt_int,                              //!< integer number.
+  opt_flag                              //!< boolean flag (integer > 0).
+};
+
+//! Built-in function option declaration.
+struct opt_decl {
+  const char*   name;                   //!< option name.
+  const char*   sc;                     //!< option short code.
+  opt_type      type;                   //!< option value type.
+  const char*   dv;                     //!< option default value (read by
+                                        //!< opt_values; empty for options a
+                                        //!< function assigns in argument order).
+};
+
+//! Class that holds the option values parsed by opt_schema.
+class opt_values {
+  public:
+    //! test if option i was specified.
+    bool found(const size_t i) const { return( val[i] != NULL ); }
+    //! return the argument value that specified option i, else NULL.
+    const std::string* given(const size_t i) const { return( val[i] ); }
+
+    //! return the text value of option i converted according to its type.
+    std::string str(const size_t i) const;
+    //! return the integer value of option i.
+    int num(const size_t i) const;
+    //! return the boolean value of option i.
+    bool flag(const size_t i) const { return( num(i) > 0 ); }
+
+  private:
+    friend class opt_schema;
+
+    //! return the specified value of option i, else its default.
+    std::string raw(const size_t i) const
+      { return( val[i] ? *val[i] : std::string(decl[i].dv) ); }
+
+    const opt_decl*                 decl; //!< option declarations.
+    std::vector<const std::string*> val;  //!< values (refer to arguments).
+};
+
+//! Class that describes the options of a built-in function.
+//! The declaration table is constant and the schema is meant to be a
+//! function-local static, so that the help string and name lookup are
+//! prepared once. Named arguments are matched in a single pass. By
+//! default, as with func_args::arg_firstof(), the first occurrence of
+//! the long name takes precedence over the first occurrence of the short
+//! code. A schema declared with \ref last takes the value given last,
+//! by either name, as functions that assign options in argument order do.
+class opt_schema {
+  public:
+    static const size_t npos = static_cast<size_t>(-1);  //!< no option.
+
+    //! schema parse modes.
+    enum mode {
+      first = 0,                        //!< first long name, else first short code.
+      last  = 1,                        //!< last occurrence of either name.
+      named = 2                         //!< positional arguments (except arg0) are invalid.
+    };
+
+    //! \brief option schema constructor.
+    //! \param d  option declaration table.
+    //! \param t  help string title.
+    //! \param m  parse mode (\ref mode values or'ed).
+    template <size_t N>
+    opt_schema(const opt_decl (&d)[N], const std::string& t="options",
+               const unsigned m=first)
+      : decl(d), count(N), modes(m) { init(t); }
+
+    //! return the number of declared options.
+    size_t size(void) const { return( count ); }
+    //! return the options help string.
+    const std::string& help(void) const { return( help_str ); }
+
+    //! return the index of the option with name or short code n, else npos.
+    size_t find(const std::string& n) const;
+
+    //! \brief parse the named arguments of a into option values v.
+    //! \param a    function arguments.
+    //! \param v    parsed option values.
+    //! \param bad  first argument that is not a declared option (or
+    //!             positional, with \ref named), else NULL.
+    //! \returns    \b true when all arguments are valid.
+    bool parse(const func_args& a, opt_values& v,
+               const func_args::arg_term*& bad) const;
+
+  private:
+    //! prepare help string and name lookup.
+    void init(const std::string& t);
+
+    const opt_decl*       decl;         //!< option declarations.
+    size_t                count;        //!< number of options.
+    unsigned              modes;        //!< parse mode.
+    std::string           help_str;     //!< options help string.
+
+    //! sorted names and short codes with (2 x option index + 1 if short).
+    std::vector< std::pair<std::string, size_t> > names;
+};
+
+
+//! Class template for a bounded least-recently-used cache of values V
+//! by key K. Inserting into a full cache discards the entry used least
+//! recently.
+template <typename K, typename V>
+class lru_cache {
+  public:
+    //! lru cache class constructor with capacity c.
+    explicit lru_cache(const size_t c=64) : capacity(c), hits(0), misses(0) {}
+
+    //! return the value for key k (made most recent), else NULL.
+    V* find(const K& k)
+    {
+      typename index_type::iterator it = index.find( k );
+
+      if ( it == index.end() ) { ++misses; return( NULL ); }
+
+      ++hits;
+      order.splice( order.begin(), order, it->second );
+      return( &it->second->second );
+    }
+
+    //! store value v for key k (most recent) and return it.
+    V& insert(const K& k, const V& v)
+    {
+      typename index_type::iterator it = index.find( k );
+
+      if ( it != index.end() )
+      {
+        order.erase( it->second );
+        index.erase( it );
+      }
+      else if ( capacity && index.size() >= capacity )
+      {
+        index.erase( order.back().first );
+        order.pop_back();
+      }
+
+      order.push_front( std::make_pair(k, v) );
+      index[ k ] = order.begin();
+
+      return( order.front().second );
+    }
+
+    //! return the number of entries.
+    size_t size(void) const { return( index.size() ); }
+    //! return the number of lookups found.
+    size_t get_hit_count(void) const { return( hits ); }
+    //! return the number of lookups not found.
+    size_t get_miss_count(void) const { return( misses ); }
+
+  private:
+    typedef std::list< std::pair<K, V> > order_type;
+    typedef std::map< K, typename order_type::iterator > index_type;
+
+    size_t      capacity;               //!< maximum entries (0=unbounded).
+    size_t      hits;                   //!< lookups found.
+    size_t      misses;                 //!< lookups not found.
+
+    order_type  order;                  //!< entries, most recent first.
+    index_type  index;                  //!< entry by key.
+};
+
+
+//! Class of characters held as a 256-entry membership table. The first
+//! few distinct members are also listed for the vector scan kernels
+//! (see UTIL::find_in()).
+class char_class {
+  public:
+    static const size_t list_max = 8;   //!< members listed for vector scans.
+
+    //! character class constructor (empty class).
+    char_class(void) { clear(); }
+    //! character class constructor with the characters of c.
+    explicit char_class(const std::string& c) { clear(); add(c); }
+
+    //! remove all characters.
+    void clear(void);
+    //! add the characters of c.
+    void add(const std::string& c);
+
+    //! test if character c is a member.
+    bool has(const char c) const
+      { return( member[ static_cast<unsigned char>(c) ] ); }
+
+    //! return the number of distinct members.
+    size_t size(void) const { return( count ); }
+    //! return the listed members (the first min(size(), list_max)).
+    const unsigned char* list(void) const { return( listed ); }
+
+  private:
+    bool            member[256];        //!< membership table.
+    unsigned char   listed[list_max];   //!< first distinct members.
+    size_t          count;              //!< number of distinct members.
+};
+
+//! Class that holds a list of words delimited in a single text string.
+//! The text is split once, in place, on a set of delimiter characters;
+//! each word is kept as a position and length so that the list can be
+//! iterated, indexed, and appended to a result without a string per
+//! word. Empty words are dropped, as with boost::char_separator.
+//!
+//! A list may also be built word by word, as the list functions build
+//! their results. A built list records which characters its words and
+//! separators use, so that a later consumer can tell whether splitting
+//! the text on its own tokenizer would give the same words, and use the
+//! list in place of splitting. A list may give up its text (release())
+//! and keep only the word positions, to be used with a copy of the text
+//! held elsewhere (bind()).
+class word_list {
+  public:
+    //! word list class constructor (empty list).
+    word_list(void) {}
+    //! \brief word list class constructor.
+    //! \param t  text to split (the list keeps its own copy).
+    //! \param d  delimiter characters.
+    //! \param s  trim leading and trailing white space from each word.
+    word_list(const std::string& t, const std::string& d, const bool s=false)
+      { assign(t, d, s); }
+
+    //! split text t on delimiters d (see constructor).
+    void assign(const std::string& t, const std::string& d, const bool s=false)
+      { assign(t.data(), t.length(), d, s); }
+    //! split the n characters of text t on delimiters d (see constructor).
+    void assign(const char* t, const size_t n, const std::string& d,
+                const bool s=false);
+
+    //! append separator s and then word w to the list text (a list that
+    //! was split is cleared first).
+    void append(const std::string& w, const std::string& s);
+    //! \brief give up the list text and return it.
+    //! \details the word positions and length are kept for bind().
+    std::string release(void);
+    //! \brief make this list the words of list l in the text at t.
+    //! \details t must hold the text of l (of length l.length()) and
+    //!          remain valid while this list is used.
+    void bind(const word_list& l, const char* t);
+
+    //! test if splitting the text on delimiters d with s gives this list.
+    bool splits_as(const std::string& d, const bool s) const;
+
+    //! test if the list was split from the n characters of t on d with s.
+    bool matches(const char* t, const size_t n, const std::string& d,
+                 const bool s) const
+      { return( !built && ext == NULL && trim == s && delim == d
+                && text.compare(0, text.npos, t, n) == 0 ); }
+
+    //! return the list text.
+    const std::string& str(void) const { return( text ); }
+    //! return the list text length.
+    size_t length(void) const { return( len ); }
+
+    //! return the number of words.
+    size_t size(void) const { return( span->size() ); }
+    //! test if the list is empty.
+    bool empty(void) const { return( span->empty() ); }
+
+    //! return word i.
+    std::string operator[](const size_t i) const
+      { return( std::string(data() + (*span)[i].first, (*span)[i].second) ); }
+    //! test if word i equals w.
+    bool equals(const size_t i, const std::string& w) const
+      { return( w.compare(0, w.npos, data() + (*span)[i].first, (*span)[i].second) == 0 ); }
+    //! append word i to r.
+    void append_to(const size_t i, std::string& r) const
+      { r.append(data() + (*span)[i].first, (*span)[i].second); }
+
+  private:
+    std::string     text;               //!< list text.
+    const char*     ext = NULL;         //!< bound text held elsewhere.
+    size_t          len = 0;            //!< list text length.
+    std::string     delim;              //!< delimiter characters.
+    bool            trim = false;       //!< words are trimmed.
+
+    bool            built = false;      //!< list was built by append().
+    bool            blank = false;      //!< a built word is empty.
+    bool            padded = false;     //!< a built word has outer white space.
+    bool            joined = false;     //!< built words are not separated.
+    std::bitset<256> word_chars;        //!< characters of built words.
+    std::bitset<256> sep_chars;         //!< characters of built separators.
+
+    //! word (position, length) in text.
+    typedef std::vector< std::pair<size_t, size_t> > span_type;
+
+    //! word positions (shared by bound lists).
+    std::shared_ptr<span_type> span = std::make_shared<span_type>();
+
+    //! clear the word positions, leaving those shared with other lists.
+    void clear_span(void)
+      { if ( span.use_count() == 1 ) span->clear();
+        else span = std::make_shared<span_type>(); }
+
+    //! return the first character of the list text.
+    const char* data(void) const { return( ext ? ext : text.data() ); }
+};
+
+//! Class that keeps the word lists of recently split texts, so that a
+//! text selected from repeatedly, such as a list indexed word by word,
+//! is split once and each selection is a lookup. Lists are found by a
+//! hash of the text and delimiters and compared before use. A text of
+//! known source, such as the value of a variable, is better kept with
+//! its source and is not looked up here.
+class word_list_cache {
+  public:
+    //! word list cache class constructor with capacity c.
+    explicit word_list_cache(const size_t c=16)
+      : lists(c), recent(false), recent_h(0) {}
+
+    //! return the list of the n characters of text t split on d with s
+    //! (see word_list); valid until the next lookup of a different text.
+    const word_list& get(const char* t, const size_t n, const std::string& d,
+                         const bool s=false);
+    //! return the list of text t split on d with s (see above).
+    const word_list& get(const std::string& t, const std::string& d,
+                         const bool s=false)
+      { return( get(t.data(), t.length(), d, s) ); }
+
+    //! return number of lookups served from a kept list (all caches).
+    static size_t get_hit_count(void) { return ( hit_count ); }
+
+  private:
+    lru_cache<uint64_t, word_list> lists; //!< lists by text hash.
+    bool            recent;             //!< a list has been returned.
+    uint64_t        recent_h;           //!< hash of the last list returned.
+
+    static size_t   hit_count;          //!< lookups served (all caches).
+};
+
+
+//! Class that visits the lines of a text buffer (not copied) in order.
+//! Lines are views into the buffer that remain valid while it does. As
+//! with reading by getline() until end of file, a buffer with n newline
+//! characters has n+1 lines.
+//! \code
+//! line_view v( t );
+//! while ( v.next() ) r.append( v.line(), v.length() );
+//! \endcode
+class line_view {
+  public:
+    //! line view class constructor for the n characters of buffer d.
+    line_view(const char* d, const size_t n) { assign(d, n); }
+    //! line view class constructor for the characters of string t.
+    explicit line_view(const std::string& t) { assign(t.data(), t.length()); }
+
+    //! visit the n characters of buffer d from the start.
+    void assign(const char* d, const size_t n)
+      { pos = d; end = d + n; done = false; cur = d; len = 0; }
+
+    //! advance to the next line; false once all lines have been visited.
+    bool next(void);
+
+    //! return the first character of the current line.
+    const char* line(void) const { return( cur ); }
+    //! return the length of the current line without its newline.
+    size_t length(void) const { return( len ); }
+
+    //! return the number of lines in the n characters of buffer d.
+    static size_t count(const char* d, const size_t n);
+
+  private:
+    const char*     pos;                //!< start of the next line.
+    const char*     end;                //!< end of buffer.
+    bool            done;               //!< last line visited.
+
+    const char*     cur;                //!< current line.
+    size_t          len;                //!< current line length.
+};
+
+//! Class that indexes the lines of a text buffer (not copied).
+//! As with reading by getline() until end of file, a buffer with n
+//! newline characters has n+1 lines.
+class line_index {
+  public:
+    //! line index class constructor (empty buffer).
+    line_index(void) { assign(NULL, 0); }
+
+    //! index the n characters of buffer d.
+    void assign(const char* d, const size_t n);
+
+    //! return the indexed buffer.
+    const char* buffer(void) const { return( data ); }
+    //! return the indexed buffer size.
+    size_t buffer_size(void) const { return( size ); }
+
+    //! return the number of lines.
+    size_t lines(void) const { return( start.size() ); }
+    //! return the first character of line i (zero based).
+    const char* line(const size_t i) const { return( data + start[i] ); }
+    //! return the length of line i (zero based) without its newline.
+    size_t length(const size_t i) const
+      { return( ((i+1) < start.size() ? start[i+1]-1 : size) - start[i] ); }
+
+    //! return the sum of all line lengths.
+    size_t total_length(void) const { return( total ); }
+    //! return the longest line length.
+    size_t max_length(void) const { return( longest ); }
+    //! return the shortest non-empty line length (npos when none).
+    size_t min_length(void) const { return( shortest ); }
+
+    static const size_t npos = static_cast<size_t>(-1);  //!< no length.
+
+  private:
+    const char*           data;         //!< buffer.
+    size_t                size;         //!< buffer size.
+    std::vector<size_t>   start;        //!< start offset of each line.
+
+    size_t                total;        //!< sum of line lengths.
+    size_t                longest;      //!< longest line length.
+    size_t                shortest;     //!< shortest non-empty line length.
+};
+
+//! Class to map files into memory once and index their lines.
+//! An entry is reloaded when the size or modification time of its file
+//! changes (to the nanosecond where the platform records it). Shared
+//! entries remain valid until released by their last holder.
+//! \note mapped data follows a file that is rewritten in place while
+//!       held; files replaced by rename are unaffected.
+class file_cache {
+  public:
+    //! return the line index of file f, or NULL if it cannot be read.
+    //! \note valid until the next lookup of the same file.
+    const line_index* get(const std::string& f)
+      { return( share( f ).get() ); }
+
+    //! return a shared line index of file f, empty if it cannot be read.
+    std::shared_ptr<const line_index> share(const std::string& f);
+
+    //! return number of files loaded (all caches).
+    static size_t get_load_count(void) { return ( load_count ); }
+    //! return number of lookups served from memory (all caches).
+    static size_t get_hit_count(void) { return ( hit_count ); }
+
+  private:
+    struct entry_s {                    //!< cached file.
+      entry_s(void) : addr(NULL) {}
+      ~entry_s(void);
+
+      void*         addr;               //!< mapped address or NULL.
+      std::string   copy;               //!< file data when not mapped.
+      uintmax_t     size;               //!< file size when loaded.
+      time_t        mtime;              //!< file mtime when loaded.
+      long          mtime_ns;           //!< file mtime nanoseconds.
+      line_index    index;              //!< line index of the data.
+    };
+
+    //! entries by file path.
+    std::map<std::string, std::shared_ptr<entry_s> > entries;
+
+    static size_t   load_count;         //!< files loaded (all caches).
+    static size_t   hit_count;          //!< lookups served (all caches).
+};
+
+//! Output stream buffer that collects output in a large reusable buffer
+//! and writes it to a file descriptor when full or when flushed.
+class output_sink : public std::streambuf {
+  public:
+    //! output sink class constructor (standard output, capacity c).
+    output_sink(const size_t c = 65536);
+    //! output sink class destructor; flushes and closes an opened file.
+    ~output_sink(void);
+
+    //! write to file f (created or truncated) in place of standard output.
+    bool open(const std::string& f);
+
+    //! append the n characters of b.
+    void write(const char* b, const size_t n)
+    {
+      if ( buf.size() + n > cap ) flush();
+      if ( n >= cap ) write_fd( b, n );
+      else            buf.append( b, n );
+    }
+
+    //! write all buffered output; \b false when any write has failed.
+    bool flush(void)
+    {
+      write_fd( buf.data(), buf.size() );
+      buf.clear();
+      return( good() );
+    }
+
+    //! test if every write has succeeded.
+    bool good(void) const { return( !failed ); }
+
+    //! return number of write system calls (all sinks).
+    static size_t get_write_count(void) { return ( write_count ); }
+
+  protected:
+    virtual int_type overflow(int_type c);
+    virtual std::streamsize xsputn(const char* s, std::streamsize n);
+    virtual int sync(void);
+
+  private:
+    std::string     buf;                //!< output buffer.
+    size_t          cap;                //!< buffer capacity.
+    int             fd;                 //!< output file descriptor.
+    bool            own;                //!< close fd on destruction.
+    bool            failed;             //!< a write has failed.
+
+    static size_t   write_count;        //!< write system calls (all sinks).
+
+    //! write the n characters of b to the file descriptor (output
+    //! after a failed write is discarded).
+    bool write_fd(const char* b, size_t n);
+};
+
+//! Input stream that reads a memory buffer without copying it.
+//! The stream holds a reference to the owner of the buffer.
+class memory_istream : public std::istream {
+  public:
+    //! construct a stream over the n characters of d owned by o.
+    memory_istream(const char* d, const size_t n,
+                   const std::shared_ptr<const void>& o)
+      : std::istream(&buf), owner(o)
+    {
+      char* p = const_cast<char*>(d);
+      buf.set( p, p + n );
+    }
+
+  private:
+    struct membuf : public std::streambuf {  //!< read-only buffer.
+      void set(char* b, char* e) { setg(b, b, e); }
+    };
+
+    membuf                      buf;    //!< stream buffer.
+    std::shared_ptr<const void> owner;  //!< buffer owner.
+};
+
+
+//! Class to run an external program as a persistent co-process.
+//! A request is written as "<length>\n<text>" to the program standard
+//! input and the response is read as "<status> <length>\n<text>" from
+//! its standard output, where status zero indicates success.
+class coprocess {
+  public:
+    //! co-process class constructor.
+    coprocess(void) : pid(-1), wfd(-1), rfd(-1),
+                      timeout(0), deadline(0), expired(false) {}
+    //! co-process class destructor; stops the program.
+    ~coprocess(void) { stop(); }
+
+    //! start program p with the single argument a.
+    bool start(const std::string& p, const std::string& a);
+    //! close the program standard input and wait for it to exit.
+    void stop(void);
+    //! test if the program is running.
+    bool running(void) const { return( pid > 0 ); }
+
+    //! set the response time limit in seconds (zero for no limit).
+    void set_timeout(const unsigned t) { timeout = t; }
+    //! test if the last request exceeded the response time limit.
+    bool timed_out(void) const { return( expired ); }
+
+    //! \brief send a request and wait for the response.
+    //! \details a program that does not respond within the time limit
+    //!          is killed and the request fails (see timed_out()).
+    //! \param q  request text.
+    //! \param r  response text.
+    //! \param s  response status.
+    //! \returns  \b false on a protocol or communication failure.
+    bool request(const std::string& q, std::string& r, int& s);
+
+  private:
+    coprocess(const coprocess&);              //!< not copyable.
+    coprocess& operator=(const coprocess&);   //!< not assignable.
+
+    int pid;                            //!< program process id.
+    int wfd;                            //!< program standard input.
+    int rfd;                            //!< program standard output.
+
+    unsigned timeout;                   //!< response time limit (seconds).
+    int64_t deadline;                   //!< response deadline (steady ms).
+    bool    expired;                    //!< the response deadline passed.
+
+    //! write n characters of b to the program.
+    bool write_all(const char* b, size_t n);
+    //! read n characters from the program to b.
+    bool read_all(char* b, size_t n);
+    //! read a line (without the newline) from the program.
+    bool read_line(std::string& l);
+};
+
+
+//! Class to run shell commands on a bounded pool of worker threads.
+class command_pool {
+  public:
+    //! command pool class constructor.
+    command_pool(void) : jobs(1), next_id(0), stopping(false) {}
+    //! command pool class destructor; waits for all workers.
+    ~command_pool(void);
+
+    //! set the maximum number of concurrent commands.
+    void set_jobs(const size_t n) { jobs = ( n > 0 ) ? n : 1; }
+    //! get the maximum number of concurrent commands.
+    size_t get_jobs(void) const { return( jobs ); }
+
+    //! \brief queue a command for execution (see UTIL::sys_command).
+    //! \param c   command string.
+    //! \param se  capture standard error output.
+    //! \param rn  replace newlines in output.
+    //! \param l   process limits.
+    //! \returns   identifier of the command.
+    size_t submit(const std::string& c, const bool se, const bool rn,
+                  const UTIL::proc_limits& l=UTIL::proc_limits());
+
+    //! test if command i has completed.
+    bool done(const size_t i);
+    //! wait for command i to complete and return its output r and status s.
+    void wait(const size_t i, std::string& r, bool& s);
+
+  private:
+    struct job_s {                      //!< command record.
+      std::string   command;            //!< command string.
+      bool          std_err;            //!< capture standard error.
+      bool          rm_nl;              //!< replace newlines.
+      UTIL::proc_limits limits;         //!< process limits.
+      std::string   result;             //!< command output.
+      bool          good;               //!< command status.
+      bool          done;               //!< command has completed.
+      bool          taken;              //!< result has been collected.
+    };
+
+    size_t                    jobs;     //!< maximum concurrent commands.
+    size_t                    next_id;  //!< identifier of first record in queue.
+    bool                      stopping; //!< workers are to exit.
+
+    std::deque<job_s>         records;  //!< command records (by identifier).
+    std::deque<size_t>        pending;  //!< commands waiting for a worker.
+    std::vector<std::thread>  workers;  //!< worker threads.
+
+    std::mutex                lock;     //!< protects all of the above.
+    std::condition_variable   queued;   //!< signals a pending command.
+    std::condition_variable   finished; //!< signals a completed command.
+
+    //! worker thread body.
+    void work(void);
+};
+
+
+//! Class for a persistent content-addressed cache of command results.
+class result_cache {
+  public:
+    //! set the cache directory path (empty disables the cache).
+    void set_path(const std::string& p) { path = p; }
+    //! get the cache directory path.
+    std::string get_path(void) const { return( path ); }
+    //! test if the cache is enabled.
+    bool enabled(void) const { return( !path.empty() ); }
+
+    //! \brief lookup key k and return the cached output r and status s.
+    //! \returns \b true when found.
+    bool get(const std::string& k, std::string& r, bool& s);
+    //! \brief store the output r and status s for key k.
+    //! \returns \b true on success.
+    bool put(const std::string& k, const std::string& r, const bool s);
+
+    //! return number of cache hits (all caches).
+    static size_t get_hit_count(void) { return ( hit_count ); }
+    //! return number of cache misses (all caches).
+    static size_t get_miss_count(void) { return ( miss_count ); }
+    //! return number of cache stores (all caches).
+    static size_t get_put_count(void) { return ( put_count ); }
+
+  private:
+    std::string     path;               //!< cache directory path.
+
+    static size_t   hit_count;          //!< cache hits (all caches).
+    static size_t   miss_count;         //!< cache misses (all caches).
+    static size_t   put_count;          //!< cache stores (all caches).
+
+    //! return the entry file name for key k.
+    std::string entry(const std::string& k) const;
+};
+
+
+//! Class to index directory listings for repeated file existence tests.
+//! Each listing records the directory modification time. After refresh()
+//! a listing is checked against the directory at its next use and the
+//! directory is listed again only when it has changed.
+class dir_index {
+  public:
+    //! dir index class constructor.
+    dir_index(void) : epoch(0) {}
+
+    //! \brief test if p names an existing regular file.
+    //! \details the directory of p is listed once; names not listed are
+    //!          rejected without a file status call.
+    bool is_file(const boost::filesystem::path& p);
+
+    //! check listings for changes at their next use (files may have
+    //! been created or removed).
+    void refresh(void) { ++epoch; }
+    //! discard all listings.
+    void clear(void) { dirs.clear(); }
+
+    //! return number of file tests (all indexes).
+    static size_t get_test_count(void) { return ( test_count ); }
+    //! return number of directories listed (all indexes).
+    static size_t get_list_count(void) { return ( list_count ); }
+    //! return number of file status calls avoided (all indexes).
+    static size_t get_avoid_count(void) { return ( avoid_count ); }
+
+  private:
+    //! directory listing.
+    struct dir_s {
+      std::set<std::string> names;      //!< names the directory contains.
+      std::time_t   mtime;              //!< directory time when listed.
+      bool          racy;               //!< changed in the second it was listed.
+      size_t        epoch;              //!< refresh epoch last checked.
+    };
+
+    //! directory path to its listing.
+    std::map<std::string, dir_s> dirs;
+    size_t          epoch;              //!< refresh epoch.
+
+    //! list directory d into l.
+    static void list(const std::string& d, dir_s& l);
+
+    static size_t   test_count;         //!< file tests (all indexes).
+    static size_t   list_count;         //!< directories listed (all indexes).
+    static size_t   avoid_count;        //!< status calls avoided (all indexes).
+};
+
+
+//! Class to record asset copies and test if a copy is up to date.
+class copy_manifest {
+  public:
+    //! copy manifest class constructor.
+    copy_manifest(void) : loaded(false), lines(0) {}
+
+    //! set the manifest file path (empty disables the manifest).
+    void set_path(const std::string& p)
+      { path = p; loaded = false; lines = 0; entries.clear(); }
+    //! get the manifest file path.
+    std::string get_path(void) const { return( path ); }
+    //! test if the manifest is enabled.
+    bool enabled(void) const { return( !path.empty() ); }
+
+    //! \brief test if target t is an up-to-date copy of source s.
+    //! \param h  compare content hashes when the metadata differs.
+    bool current(const std::string& s, const std::string& t, const bool h=false);
+    //! record target t as a copy of source s made by method m.
+    void record(const std::string& s, const std::string& t, const std::string& m);
+
+    //! return number of asset copies (all manifests).
+    static size_t get_copy_count(void) { return ( copy_count ); }
+    //! return number of up-to-date assets skipped (all manifests).
+    static size_t get_skip_count(void) { return ( skip_count ); }
+
+  private:
+    struct entry_s {                    //!< manifest entry.
+      std::string   source;             //!< source path.
+      uintmax_t     size;               //!< source size when copied.
+      time_t        mtime;              //!< source mtime when copied.
+      std::string   method;             //!< copy method.
+    };
+
+    std::string     path;               //!< manifest file path.
+    bool            loaded;             //!< manifest file has been read.
+    size_t          lines;              //!< entry lines in the manifest file.
+
+    std::map<std::string, entry_s> entries;   //!< entries by target path.
+
+    static size_t   copy_count;         //!< asset copies (all manifests).
+    static size_t   skip_count;         //!< assets skipped (all manifests).
+
+    //! read the manifest file.
+    void load(void);
+    //! rewrite the manifest file with one line per target.
+    void compact(void);
+};
+
+
+//! Class to copy assets on background threads.
+class copy_queue {
+  public:
+    //! copy queue class constructor.
+    copy_queue(void) : threads(2), active(0), stopping(false) {}
+    //! copy queue class destructor; waits for all workers.
+    ~copy_queue(void);
+
+    //! set the number of copy threads (zero copies in the caller).
+    void set_threads(const size_t n) { threads = n; }
+    //! get the number of copy threads.
+    size_t get_threads(void) const { return( threads ); }
+
+    //! copy request and result.
+    struct copy_s {
+      std::string       source;         //!< source file path.
+      std::string       target;         //!< target file path.
+      UTIL::copy_policy policy;         //!< requested copy method.
+      bool              good;           //!< copy succeeded.
+      std::string       message;        //!< method used or error message.
+    };
+
+    //! \brief queue a copy of file s to t using method p.
+    //! \returns \b false when a copy to t is already queued.
+    bool submit(const std::string& s, const std::string& t,
+                const UTIL::copy_policy p);
+
+    //! wait for all queued copies and move their results to r.
+    void drain(std::vector<copy_s>& r);
+
+  private:
+    size_t                    threads;  //!< number of copy threads.
+    size_t                    active;   //!< copies in progress.
+    bool                      stopping; //!< workers are to exit.
+
+    std::deque<copy_s>        pending;  //!< copies waiting for a worker.
+    std::vector<copy_s>       complete; //!< copies completed.
+    std::set<std::string>     targets;  //!< targets queued or completed.
+    std::vector<std::thread>  workers;  //!< worker threads.
+
+    std::mutex                lock;     //!< protects all of the above.
+    std::condition_variable   queued;   //!< signals a pending copy.
+    std::condition_variable   finished; //!< signals a completed copy.
+
+    //! perform copy c.
+    static void run(copy_s& c);
+    //! worker thread body.
+    void work(void);
+};
+
+
+//! Class to store resolved filter configurations for a project.
+//! Entries are resolved parts of a configuration (such as the text of
+//! a configuration file or the auto-search results of a scope), so that
+//! they are shared by the runs for each input file. Each entry records
+//! the state of the files it was resolved from and is used only while
+//! all of them are unchanged. Entries are kept in one file that is read
+//! once and appended to by each run that resolves new entries.
+class config_snapshot {
+  public:
+    //! resolved configuration entry.
+    struct entry_s {
+      std::string               text;       //!< entry text.
+      std::vector<std::string>  paths;      //!< entry paths.
+      std::vector<std::string>  checks;     //!< "<state> <path>" of inputs.
+    };
+
+    //! config snapshot class constructor.
+    config_snapshot(void) : loaded(false), records(0) {}
+
+    //! set the snapshot file path (empty disables the snapshot).
+    void set_path(const std::string& p) { path = p; loaded = false; }
+    //! get the snapshot file path.
+    std::string get_path(void) const { return( path ); }
+    //! test if the snapshot is enabled.
+    bool enabled(void) const { return( !path.empty() ); }
+
+    //! \brief lookup key k and return entry e when its inputs are unchanged.
+    //! \returns \b true when found and valid.
+    bool get(const std::string& k, entry_s& e);
+    //! store entry e for key k (written by flush()).
+    void put(const std::string& k, const entry_s& e);
+    //! \brief append the entries stored since the last flush to the file.
+    //! \details the file is rewritten without replaced entries when
+    //!          these outnumber the current entries.
+    //! \returns \b true on success.
+    bool flush(void);
+
+    //! return the state of path p ("-" missing, "d" directory, or size and mtime).
+    static std::string state(const std::string& p);
+    //! append a check of the current state of path p to entry e.
+    static void check(entry_s& e, const std::string& p)
+      { e.checks.push_back( state( p ) + " " + p ); }
+
+    //! return number of valid entries found (all snapshots).
+    static size_t get_hit_count(void) { return ( hit_count ); }
+    //! return number of keys not found or stale (all snapshots).
+    static size_t get_miss_count(void) { return ( miss_count ); }
+
+  private:
+    typedef std::pair<std::string, entry_s> record_t;
+
+    std::string                     path;     //!< snapshot file path.
+    bool                            loaded;   //!< entries read.
+    size_t                          records;  //!< entry records in file.
+    std::map<std::string, entry_s>  entries;  //!< entries by key.
+    std::vector<record_t>           pending;  //!< entries not yet written.
+
+    static size_t   hit_count;          //!< valid entries (all snapshots).
+    static size_t   miss_count;         //!< missing or stale (all snapshots).
+
+    //! read the snapshot file; \b false when missing or of another format.
+    bool load(void);
+};
+
+
+//! Class to record timed events and write them as a Chrome trace.
+//! Timestamps are wall-clock microseconds and events carry the process
+//! id, so the traces of separate runs can be merged into one timeline.
+class profiler {
+  public:
+    //! set the trace file path (empty disables profiling).
+    void set_path(const std::string& p) { path = p; }
+    //! get the trace file path.
+    std::string get_path(void) const { return( path ); }
+    //! test if profiling is enabled.
+    bool enabled(void) const { return( !path.empty() ); }
+
+    //! event start state.
+    struct mark_s {
+      uint64_t    ts;                   //!< wall-clock start (us).
+      uint64_t    t0;                   //!< monotonic start (us).
+      uint64_t    child;                //!< child process cpu time (us).
+      size_t      hits;                 //!< cache hit count.
+    };
+
+    //! return the start state of an event given the current cache hit count h.
+    mark_s begin(const size_t h) const;
+    //! record event n at line l of file f started at m with output of b bytes.
+    void end(const mark_s& m, const std::string& n,
+             const std::string& f, const size_t l,
+             const size_t b, const size_t h);
+
+    //! \brief return the trace file path for the process named p.
+    //! \details in the path, \%p is replaced by the process id, \%f by
+    //!          p (with '/' as '_'), and \%\% by '%'. When the path is a
+    //!          directory (or ends with '/'), the trace is written there
+    //!          as <tt>\%f.\%p.json</tt>.
+    std::string trace_path(const std::string& p) const;
+    //! \brief write the trace file (see trace_path()) naming the process p.
+    //! \returns \b true on success.
+    bool write(const std::string& p) const;
+    //! write the top c event names by total time to os.
+    void summary(std::ostream& os, const size_t c = 10) const;
+
+  private:
+    struct event_s {                    //!< recorded event.
+      std::string name;                 //!< event name.
+      std::string file;                 //!< source file.
+      size_t      line;                 //!< source line.
+      uint64_t    ts;                   //!< wall-clock start (us).
+      uint64_t    dur;                  //!< wall time (us).
+      uint64_t    child;                //!< child process cpu time (us).
+      size_t      bytes;                //!< bytes produced.
+      size_t      hits;                 //!< cache hits.
+    };
+
+    std::string           path;         //!< trace file path.
+    std::vector<event_s>  events;       //!< recorded events.
+
+    //! return child process cpu time (us).
+    static uint64_t child_time(void);
+};
+
+
 } /* end namespace ODIF */
 
 
 namespace UTIL{
 
-  //! run a system command and capture return result.
+  //! character scan kernel instruction set levels.
+  enum simd_level
+  {
+    simd_none = 0,                      //!< table lookup only.
+    simd_sse2,                          //!< 16-byte vector compares.
+    simd_avx2                           //!< 32-byte vector compares.
+  };
+
+  //! return the highest kernel level supported by the processor.
+  simd_level simd_supported(void);
+  //! return the kernel level in use (initially simd_supported()).
+  simd_level simd_active(void);
+  //! use kernel level l, limited to simd_supported(); returns the level used.
+  simd_level simd_select(const simd_level l);
+  //! return the name of kernel level l.
+  const char* simd_name(const simd_level l);
+
+  //! \brief return the position of the first character of the n
+  //!        characters of s that is a member of k, else npos.
+  //! \details classes of up to char_class::list_max members are scanned
+  //!          with vector compares when available.
+  size_t find_in(const char* s, const size_t n, const ODIF::char_class& k);
+  //! return the position of the first of the n characters of s not in k, else npos.
+  size_t find_not_in(const char* s, const size_t n, const ODIF::char_class& k);
+  //! return the position of the last of the n characters of s in k, else npos.
+  size_t rfind_in(const char* s, const size_t n, const ODIF::char_class& k);
+  //! return the position of the last of the n characters of s not in k, else npos.
+  size_t rfind_not_in(const char* s, const size_t n, const ODIF::char_class& k);
+
+  //! \brief append the n characters of s to r, replacing each member of
+  //!        k with c, or removing it when c is '\0'.
+  void replace_in(const char* s, const size_t n, const ODIF::char_class& k,
+                  const char c, std::string& r);
+
+  //! return the 64-bit FNV-1a hash of the first l characters of s.
+  uint64_t hash_fnv1a(const char* s, const size_t l,
+                      const uint64_t h=14695981039346656037ULL);
+  //! return the 64-bit FNV-1a hash of string s.
+  inline uint64_t hash_fnv1a(const std::string& s)
+    { return ( hash_fnv1a(s.data(), s.length()) ); }
+
+  //! \brief create a pipe with both descriptors closed on exec.
+  //! \details so that commands started concurrently by other threads
+  //!          do not hold the pipe open.
+  int pipe_cloexec(int fd[2]);
+
+  //! \brief run a system command and capture return result.
+  //! \details with limits \p l, the command runs in its own process
+  //!          group, which is killed when the time limit is reached; a
+  //!          command stopped by a limit fails with a message as result.
+  //!          Where limits are not supported, a command with limits fails.
   void sys_command( const std::string& command, std::string& result,
                     bool& success, const bool& standard_error=false,
-                    const bool& replace_newlines=false);
+                    const bool& replace_newlines=false,
+                    const proc_limits& l=proc_limits());
 
   //! return string indentation as the start of first non-space character.
   size_t get_indent(const std::string& t);
@@ -309,6 +1395,10 @@ namespace UTIL{
   //! unquote outermost matching quotation characters, '' or "", from string.
   std::string unquote(const std::string &s);
 
+  //! locate the text of s within its outermost matching quotation
+  //! characters (see unquote()) at position b with length l.
+  void unquote_bounds(const std::string &s, size_t& b, size_t& l);
+
   //! unquote outermost matching quotation characters and trim white space.
   std::string unquote_trim(const std::string &s);
 
@@ -337,6 +1427,50 @@ namespace UTIL{
   //! remove  ECHO from an OpenSCAD console output text
   std::string openscad_rmecho_text(const std::string &text);
 
+  //! return the 64-bit FNV-1a hash of the contents of file f.
+  uint64_t hash_file(const std::string &f);
+
+  //! set copy method p from its name n; returns \b false when unknown.
+  bool copy_policy_parse(const std::string &n, copy_policy &p);
+  //! return the name of copy method p.
+  std::string copy_policy_name(const copy_policy p);
+
+  //! \brief copy file s to t using method p, falling back to a data copy.
+  //! \param u   method used.
+  //! \param m   method name, or error message on failure.
+  //! \returns   \b true on success.
+  bool copy_asset(const std::string &s, const std::string &t,
+                  const copy_policy p, copy_policy &u, std::string &m);
+
+  //! test if each output file named by OpenSCAD arguments a exists.
+  bool openscad_outputs_exist(const std::string &a);
+
+  //! return an identity string (path, size, and mtime) for file f.
+  std::string file_identity(const std::string &f);
+
+  //! \brief write the make dependency file f for target t on files d.
+  //! \returns \b true on success.
+  bool depfile_write(const std::string &f, const std::string &t,
+                     const std::set<std::string> &d);
+
+  //! \brief test if the files of make dependency file f are unchanged.
+  //! \param f   dependency file written by depfile_write().
+  //! \param c   first missing or newer file, or error message.
+  //! \returns   \b true when no file is missing or newer than \p f.
+  bool depfile_check(const std::string &f, std::string &c);
+
+  //! \brief append identities of files included or used by OpenSCAD text.
+  //! \param t   OpenSCAD script text.
+  //! \param d   directory of the script.
+  //! \param p   library search paths.
+  //! \param k   string to append identities to.
+  //! \param v   set of files already visited.
+  void openscad_depends(const std::string &t,
+                        const std::string &d,
+                        const std::vector<std::string> &p,
+                        std::string &k,
+                        std::set<std::string> &v);
+
   //! tokenize string to a vector of string on toks.
   std::vector<std::string> string_tokenize_to_vector(
     const std::string &str,
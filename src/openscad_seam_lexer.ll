@@ -48,6 +48,7 @@ bool need_sp=false;       //!< state variable - space needed before next output
 %}
 
 %option c++
+%option prefix="seam"
 %option yyclass="SEAM::SEAM_Scanner"
 %option stack
 %option yywrap
@@ -72,6 +72,8 @@ namespace
 }
 
 
+namespace SEAM {
+
 //! output build information.
 void
 build_info(ostream& sout, const string& command_name)
@@ -253,10 +255,18 @@ write_options(
        << "#" << endl;
 }
 
+} /* end namespace SEAM */
+
+using namespace SEAM;
+
 
 //! program main.
 int
+#if defined(AMU_MULTICALL)
+openscad_seam_main(int argc, char** argv)
+#else
 main(int argc, char** argv)
+#endif
 {
   try
   {
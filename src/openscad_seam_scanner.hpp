@@ -33,7 +33,10 @@
 #ifndef __SEAM_SCANNER_HPP__
 #define __SEAM_SCANNER_HPP__ 1
 
+// distinct lexer class name: see %option prefix in lexer source.
 #if ! defined(yyFlexLexerOnce)
+#undef  yyFlexLexer
+#define yyFlexLexer seamFlexLexer
 #include <FlexLexer.h>
 #endif
 
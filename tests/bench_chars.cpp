@@ -0,0 +1,198 @@
+/***************************************************************************//**
+
+  \file   bench_chars.cpp
+
+  \author Roy Allen Sutton
+  \date   2016-2026
+
+  \copyright
+
+    This file is part of OpenSCAD AutoMake Utilities ([openscad-amu]
+    (https://royasutton.github.io/openscad-amu)).
+
+    openscad-amu is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    openscad-amu is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    [GNU General Public License] (https://www.gnu.org/licenses/gpl.html)
+    for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with openscad-amu.  If not, see <http://www.gnu.org/licenses/>.
+
+  \brief
+    Character helper microbenchmark.
+
+  \details
+    Times the UTIL string helpers on inputs shaped like those of their
+    call sites, with each character kernel level the processor supports,
+    and the per-character implementation they replace for reference.
+    Results are in MB of input per second.
+
+    usage: bench_chars [megabytes] [runs]
+*******************************************************************************/
+
+#include "openscad_dif_util.hpp"
+
+#include <boost/algorithm/string.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+using namespace std;
+
+namespace
+{
+  //! per-character replace_chars() (reference).
+  string
+  ref_replace_chars(const string &s, const string &c, const char r)
+  {
+    string result;
+
+    for ( string::const_iterator its=s.begin(); its!=s.end(); ++its ) {
+      bool append = true;
+
+      for ( string::const_iterator itc=c.begin(); itc!=c.end(); ++itc )
+        if ( *its == *itc ) { append = false; break; }
+
+      if ( append )       result += *its;
+      else if (r != '\0') result += r;
+    }
+
+    return( result );
+  }
+
+  //! std::string search unquote() (reference).
+  string
+  ref_unquote(const string &s)
+  {
+    string r = s;
+
+    size_t fc = s.find_first_not_of(" \f\n\r\t\v");
+    size_t lc = s.find_last_not_of(" \f\n\r\t\v");
+    size_t fq = s.find_first_of("\"\'");
+    size_t lq = s.find_last_of("\"\'");
+
+    if ( (fq != lq) && (fc == fq) && (lc == lq) && s.at(fq) == s.at(lq) )
+      r = ( (lq-fq) < 2 ) ? string() : s.substr( fq+1, lq-1-fq );
+
+    return( r );
+  }
+
+  //! boost::tokenizer string_tokenize_to_vector() (reference).
+  vector<string>
+  ref_tokenize(const string &str, const string &toks)
+  {
+    typedef boost::tokenizer< boost::char_separator<char> > tokenizer;
+
+    boost::char_separator<char> fs( toks.c_str(), "", boost::drop_empty_tokens );
+    tokenizer t( str, fs );
+
+    vector<string> v;
+    for ( tokenizer::iterator it=t.begin(); it!=t.end(); ++it )
+      v.push_back( boost::trim_copy( *it ) );
+
+    return( v );
+  }
+
+  //! OpenSCAD console output of about n bytes.
+  string
+  console_text(const size_t n)
+  {
+    string t;
+
+    for ( size_t i = 0; t.length() < n; ++i )
+      t += "ECHO: \"part " + UTIL::to_string( i ) + "\", size = [10, 20, "
+         + UTIL::to_string( i % 97 ) + "], center = true\n";
+
+    return( t );
+  }
+
+  //! list of about n bytes of words separated by '^'.
+  string
+  word_text(const size_t n)
+  {
+    string t;
+
+    for ( size_t i = 0; t.length() < n; ++i )
+      t += "word_" + UTIL::to_string( i ) + "^";
+
+    return( t );
+  }
+
+  //! a volatile sink, so that results are not optimized away.
+  volatile size_t sink;
+
+  //! report the rate of f over b bytes, run r times.
+  void
+  run(const string& label, const size_t b, const size_t r,
+      const function<size_t (void)>& f)
+  {
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+
+    for ( size_t i = 0; i < r; ++i )
+      sink = f();
+
+    double s = chrono::duration<double>( chrono::steady_clock::now() - t0 ).count();
+
+    printf( "  %-34s %10.1f MB/s\n", label.c_str(), ( b * r ) / s / 1e6 );
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t mb = ( argc > 1 ) ? atoi( argv[1] ) : 4;
+  const size_t runs = ( argc > 2 ) ? atoi( argv[2] ) : 10;
+
+  const string console = console_text( mb << 20 );
+  const string words = word_text( mb << 20 );
+  const string quoted = "  \"" + console.substr( 0, 4096 ) + "\"  ";
+  const string parsed = console.substr( 0, 4096 );
+
+  printf( "input %zu MB, %zu runs, supported kernels: %s\n",
+          mb, runs, UTIL::simd_name( UTIL::simd_supported() ) );
+
+  printf( "\nreference (per-character)\n" );
+
+  run( "replace_chars \\n\\r (rmnl)", console.size(), runs,
+       [&] { return ref_replace_chars( console, "\n\r", ' ' ).size(); } );
+  run( "remove_chars \\@ (error text)", parsed.size(), runs * 256,
+       [&] { return ref_replace_chars( parsed, "\\@", '\0' ).size(); } );
+  run( "unquote 4 KiB argument", quoted.size(), runs * 256,
+       [&] { return ref_unquote( quoted ).size(); } );
+  run( "tokenize ^ (list functions)", words.size(), runs,
+       [&] { return ref_tokenize( words, "^" ).size(); } );
+
+  for ( int l = UTIL::simd_none; l <= UTIL::simd_supported(); ++l )
+  {
+    UTIL::simd_select( static_cast<UTIL::simd_level>( l ) );
+
+    printf( "\nkernel: %s\n", UTIL::simd_name( UTIL::simd_active() ) );
+
+    run( "replace_chars \\n\\r (rmnl)", console.size(), runs,
+         [&] { return UTIL::replace_chars( console, "\n\r", ' ' ).size(); } );
+    run( "remove_chars \\@ (error text)", parsed.size(), runs * 256,
+         [&] { return UTIL::replace_chars( parsed, "\\@" ).size(); } );
+    run( "unquote 4 KiB argument", quoted.size(), runs * 256,
+         [&] { return UTIL::unquote( quoted ).size(); } );
+    run( "tokenize ^ (list functions)", words.size(), runs,
+         [&] { return UTIL::string_tokenize_to_vector( words, "^" ).size(); } );
+    run( "indent_text 2 (console output)", console.size(), runs,
+         [&] { return UTIL::indent_text( console, 2 ).size(); } );
+    run( "openscad_rmecho_text (console)", console.size(), runs,
+         [&] { return UTIL::openscad_rmecho_text( console ).size(); } );
+  }
+
+  return( 0 );
+}
+
+/*******************************************************************************
+// eof
+*******************************************************************************/
@@ -0,0 +1,82 @@
+#!/bin/bash
+
+#/
+#  \file       bench_output.bash
+#
+#  Output benchmark for openscad-dif.
+#
+#  Generates a large commented OpenSCAD source and filters it with each
+#  given openscad-dif executable, reporting the elapsed time and, when
+#  strace is available, the number of write system calls. Pass a build
+#  from before the output buffer as the second executable to compare.
+#
+#  usage: bench_output.bash <openscad-dif> [<baseline-openscad-dif>]
+#         [modules] [runs]
+#/
+
+dif=${1:?usage: $0 <openscad-dif> [<baseline-openscad-dif>] [modules] [runs]}
+base=${2:-}
+modules=${3:-4000}
+runs=${4:-5}
+
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+
+src=$work/bench.scad
+
+# generate source: documented modules with multi-line comment blocks
+for ((i=0; i<modules; i++)) ; do
+  cat <<EOF
+//! Module number $i of the output benchmark.
+/***************************************************************************//**
+  \param    size    (decimal) The cube edge length.
+  \param    center  (boolean) Center the cube at the origin.
+
+  \details
+
+    A generated module used to exercise comment and code echoing with
+    a definition \amu_define bench_$i (value $i) and its expansion
+    \amu_eval ( \${bench_$i} ) inside the comment text.
+
+*******************************************************************************/
+module bench_$i(size=$i, center=true)
+{
+  translate([$i, 0, 0]) cube(size=size, center=center);
+}
+
+EOF
+done > "$src"
+
+printf "source: %s lines, %s bytes, %s runs\n\n" \
+  "$(wc -l < "$src")" "$(wc -c < "$src")" "$runs"
+
+run()
+{
+  local exe=$1 label=$2 t0 t1 i
+
+  t0=$(date +%s%N)
+  for ((i=0; i<runs; i++)) ; do
+    "$exe" --search false "$src" > "$work/out.txt" || return 1
+  done
+  t1=$(date +%s%N)
+
+  printf "%-10s %8.1f ms/run" "$label" "$(echo "($t1-$t0)/1000000/$runs" | bc -l)"
+
+  if command -v strace > /dev/null 2>&1 ; then
+    strace -f -c -e trace=write -o "$work/strace.txt" \
+      "$exe" --search false "$src" > /dev/null
+    printf "  %8s write calls" \
+      "$(awk '$NF=="write" {print $4}' "$work/strace.txt")"
+  fi
+
+  printf "  %10s bytes\n" "$(wc -c < "$work/out.txt")"
+}
+
+run "$dif" "current"
+[[ -n "$base" ]] && run "$base" "baseline"
+
+exit 0
+
+#/
+# eof
+#/
@@ -0,0 +1,62 @@
+#!/bin/bash
+
+#/
+#  \file       bench_startup.bash
+#
+#  Startup benchmark for the openscad-amu programs.
+#
+#  Measures the exec-to-exit time of '--version' for each program in the
+#  given build directory, as run by the make layer, and the number of
+#  shared libraries each loads. When the multi-call executable
+#  openscad-amu exists, each program is also run through it.
+#
+#  usage: bench_startup.bash <src-build-dir> [runs]
+#/
+
+dir=${1:?usage: $0 <src-build-dir> [runs]}
+runs=${2:-200}
+
+programs="openscad-seam openscad-dif bash-dif"
+
+printf "%s runs per program\n\n" "$runs"
+
+run()
+{
+  local label=$1 t0 t1 i
+  shift
+
+  "$@" > /dev/null 2>&1 || return 1
+
+  t0=$(date +%s%N)
+  for ((i=0; i<runs; i++)) ; do
+    "$@" > /dev/null 2>&1
+  done
+  t1=$(date +%s%N)
+
+  printf "%-28s %8.3f ms/exec" "$label" \
+    "$(awk -v d=$((t1-t0)) -v n=$runs 'BEGIN {print d/1000000/n}')"
+
+  if command -v ldd > /dev/null 2>&1 ; then
+    printf "  %3s shared libraries" \
+      "$(ldd "$1" 2>/dev/null | grep -c '=>')"
+  fi
+
+  printf "\n"
+}
+
+for p in $programs ; do
+  [[ -x "$dir/$p" ]] && run "$p" "$dir/$p" --version
+done
+
+if [[ -x "$dir/openscad-amu" ]] ; then
+  printf "\n"
+  for p in $programs ; do
+    run "openscad-amu $p" "$dir/openscad-amu" $p --version
+  done
+fi
+
+exit 0
+
+#/
+# eof
+#/